@@ -11,8 +11,29 @@
 #include <tao/pq/null.hpp>
 #include <tao/pq/oid.hpp>
 
+#include <tao/pq/admission.hpp>
+#include <tao/pq/awaitable.hpp>
+#include <tao/pq/cancel_handle.hpp>
 #include <tao/pq/connection.hpp>
 #include <tao/pq/connection_pool.hpp>
+#if defined( __cpp_impl_coroutine )
+#include <tao/pq/coroutine.hpp>
+#endif
+#include <tao/pq/deadline.hpp>
+#if defined( __linux__ )
+#include <tao/pq/event_loop.hpp>
+#endif
+#include <tao/pq/hedged_pool.hpp>
+#include <tao/pq/io_statistics.hpp>
+#include <tao/pq/pool_statistics.hpp>
+#include <tao/pq/routing_pool.hpp>
+#include <tao/pq/scatter_gather.hpp>
+#include <tao/pq/scheduler.hpp>
+#include <tao/pq/sharded_pool.hpp>
+#include <tao/pq/shared_connection.hpp>
+#include <tao/pq/slow_query_log.hpp>
+#include <tao/pq/statement_hooks.hpp>
+#include <tao/pq/statement_statistics.hpp>
 #include <tao/pq/transaction.hpp>
 
 #include <tao/pq/parameter_traits.hpp>
@@ -24,6 +45,7 @@
 
 #include <tao/pq/exception.hpp>
 #include <tao/pq/result.hpp>
+#include <tao/pq/result_cache.hpp>
 
 #include <tao/pq/result_traits.hpp>
 #include <tao/pq/result_traits_aggregate.hpp>
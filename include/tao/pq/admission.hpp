@@ -0,0 +1,57 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_ADMISSION_HPP
+#define TAO_PQ_ADMISSION_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <string>
+
+namespace tao::pq
+{
+   enum class admission_policy
+   {
+      strict_priority,
+      weighted_fair
+   };
+
+   struct admission_class
+   {
+      std::string name;
+      std::size_t weight = 1;
+      std::size_t max_concurrency = std::numeric_limits< std::size_t >::max();
+   };
+
+   struct admission_statistics
+   {
+      std::string name;
+      std::size_t admitted = 0;
+      std::size_t rejected = 0;  // deadline reached while waiting
+      std::size_t in_use = 0;
+      std::size_t waiting = 0;
+      std::chrono::microseconds total_wait{};
+      std::chrono::microseconds max_wait{};
+   };
+
+   struct sizing_statistics
+   {
+      std::size_t limit = 0;
+      std::size_t min_connections = 0;
+      std::size_t max_connections = 0;
+      std::size_t increases = 0;
+      std::size_t decreases = 0;
+
+      // measurements of the last completed control interval
+      std::chrono::microseconds average_wait{};
+      std::chrono::microseconds average_hold{};
+      std::chrono::microseconds baseline_hold{};
+      double arrival_rate = 0.0;  // admissions per second
+      double estimate = 0.0;      // connections needed according to Little's law
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_AWAITABLE_HPP
+#define TAO_PQ_AWAITABLE_HPP
+
+#include <memory>
+#include <utility>
+
+#include <tao/pq/internal/async.hpp>
+
+namespace tao::pq
+{
+   // a pending asynchronous operation, co_await it with <tao/pq/coroutine.hpp>
+   template< typename T >
+   class awaitable final
+   {
+   private:
+      std::unique_ptr< internal::async_operation< T > > m_operation;
+
+   public:
+      explicit awaitable( std::unique_ptr< internal::async_operation< T > >&& operation ) noexcept
+         : m_operation( std::move( operation ) )
+      {}
+
+      awaitable( const awaitable& ) = delete;
+      awaitable( awaitable&& ) noexcept = default;
+      void operator=( const awaitable& ) = delete;
+      auto operator=( awaitable&& ) noexcept -> awaitable& = default;
+
+      ~awaitable() = default;
+
+      [[nodiscard]] auto release() && noexcept -> std::unique_ptr< internal::async_operation< T > >
+      {
+         return std::move( m_operation );
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
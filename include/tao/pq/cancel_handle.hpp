@@ -0,0 +1,79 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_CANCEL_HANDLE_HPP
+#define TAO_PQ_CANCEL_HANDLE_HPP
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <libpq-fe.h>
+
+namespace tao::pq
+{
+   class connection;
+
+   // cancels the statement currently executed by a connection,
+   // can be used from any thread, e.g. from a watchdog thread
+   class cancel_handle final
+      : public std::enable_shared_from_this< cancel_handle >
+   {
+   private:
+      friend class connection;
+
+#if defined( LIBPQ_HAS_ASYNC_CANCEL )
+      // the blocking and the non-blocking interface each use their own cancel connection
+      const std::unique_ptr< PGcancelConn, decltype( &PQcancelFinish ) > m_pgcancel;
+      const std::unique_ptr< PGcancelConn, decltype( &PQcancelFinish ) > m_async;
+      std::mutex m_mutex;
+      PostgresPollingStatusType m_status;
+#else
+      // without PQcancelStart(), a cancel worker thread sends the request for the non-blocking interface
+      struct request;
+
+      const std::unique_ptr< PGcancel, decltype( &PQfreeCancel ) > m_pgcancel;
+      std::shared_ptr< request > m_request;
+#endif
+      bool m_started;
+
+      void send_cancel( const std::optional< std::chrono::steady_clock::time_point >& end );
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class connection;
+      };
+
+   public:
+      cancel_handle( const private_key /*unused*/, PGconn* pgconn );
+
+      cancel_handle( const cancel_handle& ) = delete;
+      cancel_handle( cancel_handle&& ) = delete;
+      void operator=( const cancel_handle& ) = delete;
+      void operator=( cancel_handle&& ) = delete;
+
+      ~cancel_handle();
+
+      // blocks until the cancel request was sent or the deadline is reached
+      void cancel();
+      void cancel( const std::chrono::steady_clock::time_point end );
+      void cancel( const std::chrono::milliseconds timeout );
+
+      // non-blocking, e.g. for an event loop: start() begins to send a cancel request, afterwards
+      // wait until socket() is readable, or writable if wait_for_write(), and call poll() until it
+      // returns true; calling start() again abandons a request that is still in progress, and only
+      // one thread at a time may use this interface
+      void start();
+      [[nodiscard]] auto poll() -> bool;
+
+      [[nodiscard]] auto socket() const -> int;
+      [[nodiscard]] auto wait_for_write() const noexcept -> bool;
+   };
+
+}  // namespace tao::pq
+
+#endif
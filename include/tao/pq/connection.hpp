@@ -6,9 +6,11 @@
 #define TAO_PQ_CONNECTION_HPP
 
 #include <chrono>
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <string_view>
@@ -18,21 +20,29 @@
 
 #include <tao/pq/access_mode.hpp>
 #include <tao/pq/connection_status.hpp>
+#include <tao/pq/deadline.hpp>
+#include <tao/pq/internal/gauge.hpp>
 #include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/io_statistics.hpp>
 #include <tao/pq/isolation_level.hpp>
 #include <tao/pq/notification.hpp>
 #include <tao/pq/oid.hpp>
+#include <tao/pq/statement_hooks.hpp>
 #include <tao/pq/transaction.hpp>
 #include <tao/pq/transaction_status.hpp>
 
 namespace tao::pq
 {
+   class cancel_handle;
    class connection_pool;
+   class event_loop;
+   class scheduler;
    class table_reader;
    class table_writer;
 
    namespace internal
    {
+      class async_base;
       class top_level_transaction;
       class top_level_subtransaction;
       class nested_subtransaction;
@@ -44,10 +54,12 @@ namespace tao::pq
    {
    private:
       friend class connection_pool;
+      friend class event_loop;
       friend class table_reader;
       friend class table_writer;
       friend class transaction;
 
+      friend class internal::async_base;
       friend class internal::top_level_transaction;
       friend class internal::top_level_subtransaction;
       friend class internal::nested_subtransaction;
@@ -55,9 +67,25 @@ namespace tao::pq
       std::unique_ptr< PGconn, decltype( &PQfinish ) > m_pgconn;
       pq::transaction* m_current_transaction;
       std::optional< std::chrono::milliseconds > m_timeout;
+      std::optional< std::chrono::milliseconds > m_cancel_on_timeout;
+      std::optional< pq::deadline > m_deadline;
+      std::optional< std::chrono::microseconds > m_busy_poll;
+      std::chrono::microseconds m_spin;
+      std::shared_ptr< pq::scheduler > m_scheduler;
+      bool m_cancelling;
+      std::size_t m_deferred;
+      bool m_sync_pending;
       std::set< std::string, std::less<> > m_prepared_statements;
       std::function< void( const notification& ) > m_notification_handler;
       std::map< std::string, std::function< void( const char* ) >, std::less<> > m_notification_handlers;
+      std::shared_ptr< pq::cancel_handle > m_cancel_handle;
+      std::optional< std::string > m_session_settings;  // the key of the settings applied by connection_pool, std::nullopt if unknown
+      std::shared_ptr< statement_hooks > m_hooks;
+      pq::io_statistics m_io;
+      bool m_io_sent;  // data was sent since the last response arrived
+      std::optional< statement_event > m_event;  // the statement in flight, only with hooks
+      std::shared_ptr< internal::gauge > m_result_memory;
+      std::optional< std::size_t > m_result_limit;
 
       [[nodiscard]] auto escape_identifier( const std::string_view identifier ) const -> std::string;
 
@@ -73,21 +101,84 @@ namespace tao::pq
                         const int lengths[],
                         const int formats[] );
 
+      void send_deferred( const char* statement,
+                          const int n_params,
+                          const Oid types[],
+                          const char* const values[],
+                          const int lengths[],
+                          const int formats[] );
+
+      void connect( const std::chrono::steady_clock::time_point end );
+
+      void io_sent( const std::size_t bytes ) noexcept
+      {
+         m_io.bytes_sent += bytes;
+         m_io_sent = true;
+      }
+
+      void io_received( const std::size_t bytes ) noexcept
+      {
+         m_io.bytes_received += bytes;
+         if( m_io_sent ) {
+            ++m_io.round_trips;
+            m_io_sent = false;
+         }
+      }
+
+      void hook_start( const char* statement, const bool prepared, const int n_params, const Oid types[], const std::size_t bytes );
+      void hook_sent();
+      void hook_first_byte();
+      void hook_result( const PGresult* result );
+
+      void hook_copy_data( const std::size_t sent, const std::size_t received ) noexcept
+      {
+         if( m_event ) {
+            m_event->bytes_sent += sent;
+            m_event->bytes_received += received;
+         }
+      }
+
+      [[nodiscard]] auto has_timeout() const noexcept -> bool
+      {
+         return m_timeout || m_deadline;
+      }
+
       [[nodiscard]] auto timeout_end( const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now() ) const noexcept -> std::chrono::steady_clock::time_point;
 
+      [[nodiscard]] auto spin( const std::chrono::steady_clock::time_point end ) -> bool;
+      void adapt_spin( const std::chrono::microseconds latency ) noexcept;
       void wait( const bool wait_for_write, const std::chrono::steady_clock::time_point end );
       void cancel();
 
+      void clear_cancelled( const std::chrono::steady_clock::time_point end );
+      void reset_after_timeout() noexcept;
+
+      [[nodiscard]] auto get_next_result( const std::chrono::steady_clock::time_point end ) -> std::unique_ptr< PGresult, decltype( &PQclear ) >;
       [[nodiscard]] auto get_result( const std::chrono::steady_clock::time_point end ) -> std::unique_ptr< PGresult, decltype( &PQclear ) >;
       [[nodiscard]] auto get_copy_data( char*& buffer, const std::chrono::steady_clock::time_point end ) -> std::size_t;
       [[nodiscard]] auto get_copy_data( char*& buffer ) -> std::size_t;
 
       void put_copy_data( const char* buffer, const std::size_t size );
+      void put_copy_end( const char* error_message, const std::chrono::steady_clock::time_point end );
       void put_copy_end( const char* error_message = nullptr );
 
+      [[nodiscard]] auto collect_rows( std::unique_ptr< PGresult, decltype( &PQclear ) >& result, std::unique_ptr< PGresult, decltype( &PQclear ) > next ) -> std::optional< std::size_t >;
+      void collect_result( std::unique_ptr< PGresult, decltype( &PQclear ) >& result, std::unique_ptr< PGresult, decltype( &PQclear ) > next, const std::chrono::steady_clock::time_point end );
+      void check_result_limit( const PGresult* result );
+      [[nodiscard]] auto result_limit_message( const std::size_t size ) const -> std::string;
+      [[noreturn]] void exceed_result_limit( const std::size_t size );
+
       void clear_results( const std::chrono::steady_clock::time_point end );
       void clear_copy_data( const std::chrono::steady_clock::time_point end );
 
+      void pipeline_sync();
+      void leave_pipeline();
+      void clear_pipeline( const std::chrono::steady_clock::time_point end );
+      void check_deferred_results( const std::chrono::steady_clock::time_point end );
+
+      void sync_deferred( const std::chrono::steady_clock::time_point end );
+      void discard_deferred( const std::chrono::steady_clock::time_point end );
+
       // pass-key idiom
       class private_key final
       {
@@ -97,7 +188,7 @@ namespace tao::pq
       };
 
    public:
-      explicit connection( const private_key /*unused*/, const std::string& connection_info );
+      connection( const private_key /*unused*/, const std::string& connection_info, const std::optional< pq::deadline >& dl = std::nullopt );
 
       connection( const connection& ) = delete;
       connection( connection&& ) = delete;
@@ -107,6 +198,7 @@ namespace tao::pq
       ~connection() = default;
 
       [[nodiscard]] static auto create( const std::string& connection_info ) -> std::shared_ptr< connection >;
+      [[nodiscard]] static auto create( const std::string& connection_info, const pq::deadline& dl ) -> std::shared_ptr< connection >;
 
       [[nodiscard]] auto error_message() const -> std::string;
 
@@ -132,12 +224,21 @@ namespace tao::pq
          return transaction_status() == transaction_status::idle;
       }
 
+      [[nodiscard]] auto has_deferred() const noexcept -> bool
+      {
+         return m_deferred != 0;
+      }
+
       [[nodiscard]] auto direct() -> std::shared_ptr< pq::transaction >;
 
       [[nodiscard]] auto transaction() -> std::shared_ptr< pq::transaction >;
       [[nodiscard]] auto transaction( const access_mode am, const isolation_level il = isolation_level::default_isolation_level ) -> std::shared_ptr< pq::transaction >;
       [[nodiscard]] auto transaction( const isolation_level il, const access_mode am = access_mode::default_access_mode ) -> std::shared_ptr< pq::transaction >;
 
+      [[nodiscard]] auto write_behind_transaction() -> std::shared_ptr< pq::transaction >;
+      [[nodiscard]] auto write_behind_transaction( const access_mode am, const isolation_level il = isolation_level::default_isolation_level ) -> std::shared_ptr< pq::transaction >;
+      [[nodiscard]] auto write_behind_transaction( const isolation_level il, const access_mode am = access_mode::default_access_mode ) -> std::shared_ptr< pq::transaction >;
+
       void prepare( const std::string& name, const std::string& statement );
       void deallocate( const std::string& name );
 
@@ -157,6 +258,8 @@ namespace tao::pq
       void handle_notifications();
       void get_notifications();
 
+      [[nodiscard]] auto cancel_handle() -> std::shared_ptr< pq::cancel_handle >;
+
       [[nodiscard]] auto socket() const -> int;
 
       [[nodiscard]] decltype( auto ) timeout() const noexcept
@@ -167,6 +270,79 @@ namespace tao::pq
       void set_timeout( const std::chrono::milliseconds timeout );
       void reset_timeout() noexcept;
 
+      [[nodiscard]] decltype( auto ) cancel_on_timeout() const noexcept
+      {
+         return m_cancel_on_timeout;
+      }
+
+      void set_cancel_on_timeout( const std::chrono::milliseconds grace_period );
+      void reset_cancel_on_timeout() noexcept;
+
+      [[nodiscard]] decltype( auto ) busy_poll() const noexcept
+      {
+         return m_busy_poll;
+      }
+
+      void set_busy_poll( const std::chrono::microseconds spin_budget );
+      void reset_busy_poll() noexcept;
+
+      // the current, adaptive spin budget
+      [[nodiscard]] auto spin_budget() const noexcept -> std::chrono::microseconds
+      {
+         return m_busy_poll ? m_spin : std::chrono::microseconds( 0 );
+      }
+
+      [[nodiscard]] auto scheduler() const noexcept -> const std::shared_ptr< pq::scheduler >&
+      {
+         return m_scheduler;
+      }
+
+      void set_scheduler( const std::shared_ptr< pq::scheduler >& scheduler ) noexcept;
+      void reset_scheduler() noexcept;
+
+      // counters for the I/O on the connection's socket, only the caller's thread blocks in poll()
+      [[nodiscard]] auto io_statistics() const noexcept -> const pq::io_statistics&
+      {
+         return m_io;
+      }
+
+      void reset_io_statistics() noexcept
+      {
+         m_io = pq::io_statistics();
+      }
+
+      [[nodiscard]] auto hooks() const noexcept -> const std::shared_ptr< statement_hooks >&
+      {
+         return m_hooks;
+      }
+
+      // statements whose results are retrieved are reported, deferred statements are not
+      void set_hooks( const std::shared_ptr< statement_hooks >& hooks ) noexcept;
+      void reset_hooks() noexcept;
+
+      // bytes held by the results of this connection which are still alive
+      [[nodiscard]] auto result_memory() const noexcept -> std::size_t
+      {
+         return m_result_memory->value();
+      }
+
+      [[nodiscard]] decltype( auto ) result_limit() const noexcept
+      {
+         return m_result_limit;
+      }
+
+      // results are received in single-row mode and the statement is cancelled when they exceed the limit
+      void set_result_limit( const std::size_t bytes );
+      void reset_result_limit() noexcept;
+
+      [[nodiscard]] decltype( auto ) deadline() const noexcept
+      {
+         return m_deadline;
+      }
+
+      void set_deadline( const pq::deadline& dl );
+      void reset_deadline() noexcept;
+
       [[nodiscard]] auto underlying_raw_ptr() noexcept -> PGconn*
       {
          return m_pgconn.get();
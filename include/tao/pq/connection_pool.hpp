@@ -5,29 +5,62 @@
 #ifndef TAO_PQ_CONNECTION_POOL_HPP
 #define TAO_PQ_CONNECTION_POOL_HPP
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
+#include <tao/pq/admission.hpp>
 #include <tao/pq/connection.hpp>
+#include <tao/pq/deadline.hpp>
+#include <tao/pq/internal/admission.hpp>
+#include <tao/pq/internal/gauge.hpp>
+#include <tao/pq/internal/histogram.hpp>
 #include <tao/pq/internal/pool.hpp>
+#include <tao/pq/internal/single_flight.hpp>
+#include <tao/pq/internal/statement_key.hpp>
 #include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/pool_statistics.hpp>
 #include <tao/pq/result.hpp>
 
 namespace tao::pq
 {
+   // run-time parameters, see https://www.postgresql.org/docs/current/functions-admin.html#FUNCTIONS-ADMIN-SET
+   using session_settings = std::map< std::string, std::string, std::less<> >;
+
    class connection_pool final
       : public internal::pool< connection >
    {
    private:
       const std::string m_connection_info;
       std::optional< std::chrono::milliseconds > m_timeout;
+      std::optional< std::chrono::milliseconds > m_cancel_on_timeout;
+      std::optional< std::chrono::microseconds > m_busy_poll;
+      std::shared_ptr< statement_hooks > m_hooks;
+      std::optional< std::size_t > m_result_limit;
+      const std::shared_ptr< internal::gauge > m_result_memory;
+      std::shared_ptr< internal::admission > m_admission;  // only accessed with std::atomic_load() and std::atomic_store()
+      internal::single_flight m_single_flight;
+      std::atomic< std::size_t > m_session_hits;
+      std::atomic< std::size_t > m_session_migrations;
+      internal::histogram m_checkout_latency;
 
+      [[nodiscard]] auto create_connection( const std::optional< pq::deadline >& dl ) const -> std::unique_ptr< pq::connection >;
       [[nodiscard]] auto v_create() const -> std::unique_ptr< pq::connection > override;
 
+      void configure( pq::connection& c ) const;
+
+      [[nodiscard]] auto admit( const std::size_t admission_class, const std::optional< std::chrono::steady_clock::time_point >& end ) -> std::shared_ptr< void >;
+      [[nodiscard]] auto checkout( const std::size_t admission_class, const std::optional< pq::deadline >& dl, const session_settings& settings ) -> std::shared_ptr< pq::connection >;
+
+      void apply( pq::connection& c, const std::string& key, const session_settings& settings );
+
       [[nodiscard]] auto v_is_valid( connection& c ) const noexcept -> bool override
       {
          return c.is_idle();
@@ -53,13 +86,108 @@ namespace tao::pq
       void set_timeout( const std::chrono::milliseconds timeout );
       void reset_timeout() noexcept;
 
+      [[nodiscard]] decltype( auto ) cancel_on_timeout() const noexcept
+      {
+         return m_cancel_on_timeout;
+      }
+
+      void set_cancel_on_timeout( const std::chrono::milliseconds grace_period );
+      void reset_cancel_on_timeout() noexcept;
+
+      [[nodiscard]] decltype( auto ) busy_poll() const noexcept
+      {
+         return m_busy_poll;
+      }
+
+      void set_busy_poll( const std::chrono::microseconds spin_budget );
+      void reset_busy_poll() noexcept;
+
+      [[nodiscard]] auto hooks() const noexcept -> const std::shared_ptr< statement_hooks >&
+      {
+         return m_hooks;
+      }
+
+      void set_hooks( const std::shared_ptr< statement_hooks >& hooks ) noexcept;
+      void reset_hooks() noexcept;
+
+      [[nodiscard]] decltype( auto ) result_limit() const noexcept
+      {
+         return m_result_limit;
+      }
+
+      void set_result_limit( const std::size_t bytes );
+      void reset_result_limit() noexcept;
+
+      // bytes held by the results of all connections of the pool which are still alive
+      [[nodiscard]] auto result_memory() const noexcept -> std::size_t
+      {
+         return m_result_memory->value();
+      }
+
+      // limits the number of borrowed connections, waiting requests are admitted per class
+      void set_admission( const std::size_t max_connections, const std::vector< admission_class >& classes, const admission_policy policy = admission_policy::weighted_fair );
+      void reset_admission() noexcept;
+
+      [[nodiscard]] auto admission_statistics() const -> std::vector< pq::admission_statistics >;
+
+      // resizes the limit for borrowed connections between min and max based on measurements,
+      // without admission classes a single class is used, idle connections beyond the limit are closed
+      void set_adaptive_sizing( const std::size_t min_connections, const std::size_t max_connections );
+      void reset_adaptive_sizing() noexcept;
+
+      [[nodiscard]] auto sizing_statistics() const -> std::optional< pq::sizing_statistics >;
+
+      // without an admission class, connections are borrowed as the first admission class
       [[nodiscard]] auto connection() -> std::shared_ptr< connection >;
+      [[nodiscard]] auto connection( const pq::deadline& dl ) -> std::shared_ptr< pq::connection >;
+      [[nodiscard]] auto connection( const std::size_t admission_class ) -> std::shared_ptr< pq::connection >;
+      [[nodiscard]] auto connection( const std::size_t admission_class, const pq::deadline& dl ) -> std::shared_ptr< pq::connection >;
+
+      // idle connections with the same settings are preferred, otherwise the least
+      // recently used idle connection is reconfigured, connections borrowed without
+      // settings use the server's defaults
+      [[nodiscard]] auto connection( const session_settings& settings ) -> std::shared_ptr< pq::connection >;
+      [[nodiscard]] auto connection( const session_settings& settings, const pq::deadline& dl ) -> std::shared_ptr< pq::connection >;
+
+      // number of connections borrowed with settings that were already applied
+      [[nodiscard]] auto session_hits() const noexcept -> std::size_t
+      {
+         return m_session_hits.load( std::memory_order_relaxed );
+      }
+
+      // number of connections that had to be reconfigured
+      [[nodiscard]] auto session_migrations() const noexcept -> std::size_t
+      {
+         return m_session_migrations.load( std::memory_order_relaxed );
+      }
+
+      // a snapshot of the pool's counters and histograms, see also to_prometheus()
+      [[nodiscard]] auto statistics() const -> pool_statistics;
 
       template< typename... As >
       auto execute( const internal::zsv statement, As&&... as )
       {
          return connection()->direct()->execute( statement, std::forward< As >( as )... );
       }
+
+      // concurrent calls with identical statements and parameters share a single execution,
+      // only use this for read-only statements whose result may be shared by all callers
+      template< typename... As >
+      auto execute_coalesced( const internal::zsv statement, As&&... as ) -> result
+      {
+         return m_single_flight.execute( internal::make_statement_key( statement, as... ),
+                                         [ & ] { return connection_pool::execute( statement, std::forward< As >( as )... ); } );
+      }
+
+      [[nodiscard]] auto coalesced_hits() const noexcept -> std::size_t
+      {
+         return m_single_flight.hits();
+      }
+
+      [[nodiscard]] auto coalesced_misses() const noexcept -> std::size_t
+      {
+         return m_single_flight.misses();
+      }
    };
 
 }  // namespace tao::pq
@@ -0,0 +1,105 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_COROUTINE_HPP
+#define TAO_PQ_COROUTINE_HPP
+
+#if !defined( __cpp_impl_coroutine )
+#error "tao/pq/coroutine.hpp requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include <tao/pq/awaitable.hpp>
+#include <tao/pq/connection.hpp>
+#include <tao/pq/internal/async.hpp>
+#include <tao/pq/internal/poll.hpp>
+#include <tao/pq/scheduler.hpp>
+
+namespace tao::pq
+{
+   namespace internal
+   {
+      template< typename T >
+      class awaiter final
+      {
+      private:
+         std::unique_ptr< async_operation< T > > m_operation;
+         std::exception_ptr m_error;
+         std::coroutine_handle<> m_handle;
+
+         void watch()
+         {
+            const auto& op = *m_operation;
+            op.scheduler()->watch(
+               op.socket(), op.wait_for_write(), [ this ]( const poll_status status ) { ready( status ); }, op.end() );
+         }
+
+         void ready( const poll_status status )
+         {
+            try {
+               if( !m_operation->resume( status ) ) {
+                  awaiter::watch();
+                  return;
+               }
+            }
+            catch( ... ) {
+               m_error = std::current_exception();
+            }
+            m_handle.resume();
+         }
+
+      public:
+         explicit awaiter( pq::awaitable< T >&& a ) noexcept
+            : m_operation( std::move( a ).release() )
+         {}
+
+         awaiter( const awaiter& ) = delete;
+         awaiter( awaiter&& ) = delete;
+         void operator=( const awaiter& ) = delete;
+         void operator=( awaiter&& ) = delete;
+
+         ~awaiter() = default;
+
+         [[nodiscard]] auto await_ready() noexcept -> bool
+         {
+            try {
+               // no event yet, only make the progress that is possible right away
+               return m_operation->resume( poll_status::again );
+            }
+            catch( ... ) {
+               m_error = std::current_exception();
+               return true;
+            }
+         }
+
+         void await_suspend( const std::coroutine_handle<> handle )
+         {
+            m_handle = handle;
+            awaiter::watch();
+         }
+
+         auto await_resume() -> T
+         {
+            if( m_error ) {
+               std::rethrow_exception( m_error );
+            }
+            return m_operation->get();
+         }
+      };
+
+   }  // namespace internal
+
+   template< typename T >
+   [[nodiscard]] auto operator co_await( pq::awaitable< T >&& a ) noexcept
+   {
+      return internal::awaiter< T >( std::move( a ) );
+   }
+
+}  // namespace tao::pq
+
+#endif
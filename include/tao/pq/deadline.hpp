@@ -0,0 +1,47 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_DEADLINE_HPP
+#define TAO_PQ_DEADLINE_HPP
+
+#include <chrono>
+
+namespace tao::pq
+{
+   // a point in time until which a whole request has to be finished
+   class deadline final
+   {
+   private:
+      std::chrono::steady_clock::time_point m_end;
+
+   public:
+      explicit deadline( const std::chrono::steady_clock::time_point end ) noexcept
+         : m_end( end )
+      {}
+
+      [[nodiscard]] static auto after( const std::chrono::milliseconds timeout ) noexcept -> deadline
+      {
+         return deadline( std::chrono::steady_clock::now() + timeout );
+      }
+
+      [[nodiscard]] auto end() const noexcept -> std::chrono::steady_clock::time_point
+      {
+         return m_end;
+      }
+
+      [[nodiscard]] auto remaining() const noexcept -> std::chrono::steady_clock::duration
+      {
+         const auto now = std::chrono::steady_clock::now();
+         return ( now < m_end ) ? ( m_end - now ) : std::chrono::steady_clock::duration::zero();
+      }
+
+      [[nodiscard]] auto expired() const noexcept -> bool
+      {
+         return std::chrono::steady_clock::now() >= m_end;
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
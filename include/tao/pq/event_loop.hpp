@@ -0,0 +1,133 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_EVENT_LOOP_HPP
+#define TAO_PQ_EVENT_LOOP_HPP
+
+#if !defined( __linux__ )
+#error "tao::pq::event_loop requires epoll, which is only available on Linux"
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/internal/async.hpp>
+#include <tao/pq/internal/poll.hpp>
+#include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/result.hpp>
+#include <tao/pq/scheduler.hpp>
+#include <tao/pq/transaction.hpp>
+
+namespace tao::pq
+{
+   // drives many connections from a single thread, the event loop
+   // itself is not thread-safe and must only be used by one thread
+   class event_loop final
+      : public scheduler
+   {
+   public:
+      using result_handler = std::function< void( pq::result&& ) >;
+      using error_handler = std::function< void( std::exception_ptr ) >;
+
+   private:
+      using timer_map = std::multimap< std::chrono::steady_clock::time_point, int >;
+
+      struct watcher
+      {
+         ready_handler handler;
+         timer_map::iterator timer;
+      };
+
+      struct operation
+      {
+         std::unique_ptr< internal::result_operation > async;
+         result_handler on_result;
+         error_handler on_error;
+      };
+
+      const int m_epoll;
+      std::unordered_map< int, watcher > m_watchers;
+      timer_map m_timers;
+
+      void v_watch( const int socket, const bool wait_for_write, ready_handler handler, const std::optional< std::chrono::steady_clock::time_point >& end ) override;
+
+      void start( const std::shared_ptr< pq::transaction >& tr,
+                  const std::chrono::steady_clock::time_point start,
+                  result_handler&& on_result,
+                  error_handler&& on_error );
+
+      void step( const std::shared_ptr< operation >& op, const internal::poll_status status );
+
+      [[nodiscard]] auto fire( const int socket, const internal::poll_status status ) -> bool;
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class event_loop;
+      };
+
+   public:
+      explicit event_loop( const private_key /*unused*/ );
+
+      event_loop( const event_loop& ) = delete;
+      event_loop( event_loop&& ) = delete;
+      void operator=( const event_loop& ) = delete;
+      void operator=( event_loop&& ) = delete;
+
+      ~event_loop() override;
+
+      [[nodiscard]] static auto create() -> std::shared_ptr< event_loop >;
+
+      void unwatch( const int socket ) noexcept;
+
+      // sends the statement on the transaction and completes it asynchronously,
+      // the transaction can not be used by anyone else until a handler is called
+      template< typename... As >
+      void execute( const std::shared_ptr< pq::transaction >& tr, result_handler on_result, error_handler on_error, const internal::zsv statement, As&&... as )
+      {
+         const auto start = std::chrono::steady_clock::now();
+         if( tr->connection()->has_deferred() ) {
+            throw std::logic_error( "invalid asynchronous statement, deferred statements pending" );
+         }
+         tr->send( statement, std::forward< As >( as )... );
+         event_loop::start( tr, start, std::move( on_result ), std::move( on_error ) );
+      }
+
+      // executes the statement in autocommit mode, the connection is locked until a handler is called
+      template< typename... As >
+      void execute( const std::shared_ptr< pq::connection >& connection, result_handler on_result, error_handler on_error, const internal::zsv statement, As&&... as )
+      {
+         event_loop::execute( connection->direct(), std::move( on_result ), std::move( on_error ), statement, std::forward< As >( as )... );
+      }
+
+      [[nodiscard]] auto size() const noexcept -> std::size_t
+      {
+         return m_watchers.size();
+      }
+
+      [[nodiscard]] auto empty() const noexcept -> bool
+      {
+         return m_watchers.empty();
+      }
+
+      // waits for events and dispatches them, returns the number of handlers called
+      auto run_once( const std::optional< std::chrono::milliseconds >& timeout = std::nullopt ) -> std::size_t;
+
+      // dispatches events until no socket is watched anymore
+      void run();
+   };
+
+}  // namespace tao::pq
+
+#endif
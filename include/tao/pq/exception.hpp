@@ -19,6 +19,13 @@ namespace tao::pq
       using std::runtime_error::runtime_error;
    };
 
+   // the result of a statement exceeded the connection's result limit
+   struct result_limit_exceeded
+      : std::runtime_error
+   {
+      using std::runtime_error::runtime_error;
+   };
+
    // https://www.postgresql.org/docs/current/errcodes-appendix.html
    struct sql_error
       : std::runtime_error
@@ -0,0 +1,112 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_HEDGED_POOL_HPP
+#define TAO_PQ_HEDGED_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/result.hpp>
+#include <tao/pq/transaction.hpp>
+
+namespace tao::pq
+{
+   // executes read-only statements on a primary pool and, if no result arrived
+   // after the hedge delay, additionally on a secondary pool; the first result wins
+   class hedged_pool final
+   {
+   private:
+      struct attempt;
+
+      const std::shared_ptr< connection_pool > m_primary;
+      const std::shared_ptr< connection_pool > m_secondary;
+
+      mutable std::mutex m_mutex;
+      std::optional< std::chrono::microseconds > m_hedge_delay;
+      std::array< std::chrono::microseconds, 128 > m_latencies;
+      std::size_t m_samples;
+      std::list< std::unique_ptr< attempt > > m_draining;
+
+      std::atomic< std::size_t > m_hedges;
+      std::atomic< std::size_t > m_failovers;
+      std::atomic< std::size_t > m_secondary_wins;
+
+      [[nodiscard]] auto execute_hedged( const std::function< void( transaction& ) >& send ) -> result;
+
+      void record( const std::chrono::microseconds latency );
+      void abandon( std::unique_ptr< attempt >&& a );
+      void drain( const bool wait );
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class hedged_pool;
+      };
+
+   public:
+      hedged_pool( const private_key /*unused*/, const std::shared_ptr< connection_pool >& primary, const std::shared_ptr< connection_pool >& secondary );
+
+      hedged_pool( const hedged_pool& ) = delete;
+      hedged_pool( hedged_pool&& ) = delete;
+      void operator=( const hedged_pool& ) = delete;
+      void operator=( hedged_pool&& ) = delete;
+
+      ~hedged_pool();
+
+      [[nodiscard]] static auto create( const std::shared_ptr< connection_pool >& primary, const std::shared_ptr< connection_pool >& secondary ) -> std::shared_ptr< hedged_pool >;
+
+      [[nodiscard]] auto primary() const noexcept -> const std::shared_ptr< connection_pool >&
+      {
+         return m_primary;
+      }
+
+      [[nodiscard]] auto secondary() const noexcept -> const std::shared_ptr< connection_pool >&
+      {
+         return m_secondary;
+      }
+
+      // a fixed hedge delay, by default the delay is the p95 of recent latencies
+      void set_hedge_delay( const std::chrono::microseconds delay );
+      void reset_hedge_delay() noexcept;
+
+      // the current hedge delay, empty while there are not enough samples
+      [[nodiscard]] auto hedge_delay() const -> std::optional< std::chrono::microseconds >;
+
+      // only use this for read-only statements, the parameters are sent to both pools
+      template< typename... As >
+      auto execute( const internal::zsv statement, const As&... as ) -> result
+      {
+         return hedged_pool::execute_hedged( [ & ]( transaction& tr ) { tr.send( statement, as... ); } );
+      }
+
+      [[nodiscard]] auto hedges() const noexcept -> std::size_t
+      {
+         return m_hedges.load( std::memory_order_relaxed );
+      }
+
+      [[nodiscard]] auto failovers() const noexcept -> std::size_t
+      {
+         return m_failovers.load( std::memory_order_relaxed );
+      }
+
+      [[nodiscard]] auto secondary_wins() const noexcept -> std::size_t
+      {
+         return m_secondary_wins.load( std::memory_order_relaxed );
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_ADMISSION_HPP
+#define TAO_PQ_INTERNAL_ADMISSION_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <tao/pq/admission.hpp>
+
+namespace tao::pq::internal
+{
+   // limits the number of concurrently borrowed connections and decides
+   // which of the waiting requests is admitted when a connection is returned
+   class admission final
+      : public std::enable_shared_from_this< admission >
+   {
+   private:
+      struct waiter final
+      {
+         std::condition_variable condition;
+         bool granted = false;
+      };
+
+      struct state final
+      {
+         admission_class config;
+         std::uint64_t pass = 0;  // virtual time for weighted fair admission
+         std::list< waiter* > waiting;
+         admission_statistics statistics;
+      };
+
+      // measurements for adaptive sizing, collected over one control interval
+      struct window final
+      {
+         std::chrono::steady_clock::time_point start;
+         std::size_t admitted = 0;
+         std::chrono::microseconds wait{};
+         std::size_t released = 0;
+         std::chrono::microseconds hold{};
+         std::size_t peak_in_use = 0;
+         bool queued = false;
+      };
+
+      const admission_policy m_policy;
+
+      mutable std::mutex m_mutex;
+      std::vector< state > m_classes;
+      std::size_t m_limit;
+      std::size_t m_in_use;
+      std::uint64_t m_virtual_time;
+
+      std::optional< std::pair< std::size_t, std::size_t > > m_sizing;  // min and max
+      window m_window;
+      sizing_statistics m_sizing_statistics;
+
+      [[nodiscard]] auto eligible( const std::size_t index ) const noexcept -> bool;
+      [[nodiscard]] auto select() const noexcept -> std::optional< std::size_t >;
+
+      void grant( const std::size_t index ) noexcept;
+      void dispatch() noexcept;
+      void release( const std::size_t index, const std::chrono::steady_clock::time_point since ) noexcept;
+      void adapt( const std::chrono::steady_clock::time_point now ) noexcept;
+
+   public:
+      admission( const std::size_t max_connections, const std::vector< admission_class >& classes, const admission_policy policy );
+
+      admission( const admission& ) = delete;
+      admission( admission&& ) = delete;
+      void operator=( const admission& ) = delete;
+      void operator=( admission&& ) = delete;
+
+      ~admission() = default;
+
+      // the current limit for the number of borrowed connections
+      [[nodiscard]] auto limit() const -> std::size_t;
+
+      [[nodiscard]] auto policy() const noexcept -> admission_policy
+      {
+         return m_policy;
+      }
+
+      // blocks until the request is admitted, the result must be kept for as long
+      // as the connection is borrowed, destroying it frees the slot for the next request
+      [[nodiscard]] auto acquire( const std::size_t index, const std::optional< std::chrono::steady_clock::time_point >& end ) -> std::shared_ptr< void >;
+
+      [[nodiscard]] auto statistics() const -> std::vector< admission_statistics >;
+
+      // adjusts the limit between min and max based on the measured
+      // wait times, hold times and arrival rates once per interval
+      void set_sizing( const std::size_t min_connections, const std::size_t max_connections );
+      void reset_sizing() noexcept;
+
+      [[nodiscard]] auto sizing() const -> std::optional< sizing_statistics >;
+   };
+
+}  // namespace tao::pq::internal
+
+#endif
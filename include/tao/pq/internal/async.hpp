@@ -0,0 +1,187 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_ASYNC_HPP
+#define TAO_PQ_INTERNAL_ASYNC_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include <libpq-fe.h>
+
+#include <tao/pq/internal/poll.hpp>
+#include <tao/pq/result.hpp>
+
+namespace tao::pq
+{
+   class cancel_handle;
+   class connection;
+   class scheduler;
+   class table_reader;
+   class table_writer;
+   class transaction;
+
+   namespace internal
+   {
+      // a non-blocking state machine which is driven by socket readiness
+      class async_base
+      {
+      private:
+         std::shared_ptr< pq::connection > m_connection;
+         std::optional< std::chrono::steady_clock::time_point > m_end;
+
+         // set while a statement is cancelled, e.g. after a timeout: first the cancel request is sent,
+         // m_cancel is released once it was sent, then the remaining results are discarded
+         bool m_cancelling;
+         std::shared_ptr< pq::cancel_handle > m_cancel;
+         std::optional< std::chrono::steady_clock::time_point > m_grace_end;
+         std::exception_ptr m_reason;
+
+         [[nodiscard]] auto drain() -> bool;
+         [[nodiscard]] auto cancelled( const poll_status status ) -> bool;
+         [[noreturn]] void aborted( const bool keep_connection );
+
+      protected:
+         bool m_wait_for_write;
+
+         async_base( const std::shared_ptr< pq::connection >& connection, const std::chrono::steady_clock::time_point start );
+
+         [[nodiscard]] auto pgconn() const noexcept -> PGconn*;
+         [[nodiscard]] auto make_result( PGresult* pgresult ) const -> pq::result;
+
+         // the building blocks, each returns false when it needs to wait for the socket
+         [[nodiscard]] auto flush() -> bool;
+         [[nodiscard]] auto fetch( std::unique_ptr< PGresult, decltype( &PQclear ) >& result ) -> bool;
+
+         // cancels the statement without blocking, the reason is thrown once the statement is cancelled,
+         // the connection is closed if that fails or does not happen before the grace period ends
+         [[nodiscard]] auto cancel( const std::exception_ptr& reason, const std::optional< std::chrono::steady_clock::time_point >& grace_end ) -> bool;
+
+         // reports the progress of the statement to the connection's hooks, if any
+         void hook_sent();
+         void hook_result( const PGresult* result );
+         void received_copy_data( const std::size_t received ) noexcept;
+         void copy_end_sent() noexcept;
+
+         [[nodiscard]] virtual auto v_resume() -> bool = 0;
+
+      public:
+         virtual ~async_base() = default;
+
+         async_base( const async_base& ) = delete;
+         async_base( async_base&& ) = delete;
+         void operator=( const async_base& ) = delete;
+         void operator=( async_base&& ) = delete;
+
+         [[nodiscard]] auto connection() const noexcept -> const std::shared_ptr< pq::connection >&
+         {
+            return m_connection;
+         }
+
+         [[nodiscard]] auto scheduler() const -> const std::shared_ptr< pq::scheduler >&;
+
+         [[nodiscard]] auto socket() const -> int;
+
+         [[nodiscard]] auto wait_for_write() const noexcept -> bool
+         {
+            return m_wait_for_write;
+         }
+
+         [[nodiscard]] auto end() const noexcept -> const std::optional< std::chrono::steady_clock::time_point >&
+         {
+            return m_end;
+         }
+
+         // makes as much progress as possible without blocking, returns true when the operation
+         // completed, false when the caller has to wait for the socket as given by wait_for_write()
+         [[nodiscard]] auto resume( const poll_status status ) -> bool;
+
+         // cancels the statement when its result is no longer needed, afterwards resume() throws
+         // once the statement is cancelled, the connection is closed if that takes until the deadline
+         void abandon( const std::chrono::steady_clock::time_point end );
+      };
+
+      template< typename T >
+      class async_operation
+         : public async_base
+      {
+      protected:
+         using async_base::async_base;
+
+         virtual auto v_get() -> T = 0;
+
+      public:
+         // retrieves the outcome of a completed operation, throws on failure
+         auto get() -> T
+         {
+            return v_get();
+         }
+      };
+
+      class result_operation final
+         : public async_operation< pq::result >
+      {
+      private:
+         std::shared_ptr< pq::transaction > m_transaction;
+         std::unique_ptr< PGresult, decltype( &PQclear ) > m_result;
+         bool m_flushed;
+
+         [[nodiscard]] auto v_resume() -> bool override;
+         [[nodiscard]] auto v_get() -> pq::result override;
+
+      public:
+         result_operation( const std::shared_ptr< pq::transaction >& tr, const std::chrono::steady_clock::time_point start );
+      };
+
+      class table_row_operation final
+         : public async_operation< bool >
+      {
+      private:
+         table_reader& m_reader;
+         std::unique_ptr< PGresult, decltype( &PQclear ) > m_result;
+         bool m_finished;
+
+         [[nodiscard]] auto v_resume() -> bool override;
+         [[nodiscard]] auto v_get() -> bool override;
+
+      public:
+         explicit table_row_operation( table_reader& reader );
+      };
+
+      class table_flush_operation final
+         : public async_operation< void >
+      {
+      private:
+         [[nodiscard]] auto v_resume() -> bool override;
+         void v_get() override {}
+
+      public:
+         explicit table_flush_operation( table_writer& writer );
+      };
+
+      class table_commit_operation final
+         : public async_operation< std::size_t >
+      {
+      private:
+         table_writer& m_writer;
+         std::unique_ptr< PGresult, decltype( &PQclear ) > m_result;
+         bool m_ended;
+         bool m_flushed;
+
+         [[nodiscard]] auto v_resume() -> bool override;
+         [[nodiscard]] auto v_get() -> std::size_t override;
+
+      public:
+         explicit table_commit_operation( table_writer& writer );
+      };
+
+   }  // namespace internal
+
+}  // namespace tao::pq
+
+#endif
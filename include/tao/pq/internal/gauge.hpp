@@ -0,0 +1,59 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_GAUGE_HPP
+#define TAO_PQ_INTERNAL_GAUGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace tao::pq::internal
+{
+   // lock-free gauge of the bytes held by live objects, which are also
+   // accounted in the parent, e.g. the pool the connection belongs to
+   class gauge final
+   {
+   private:
+      std::atomic< std::size_t > m_value;
+      const std::shared_ptr< gauge > m_parent;
+
+   public:
+      explicit gauge( const std::shared_ptr< gauge >& parent = nullptr ) noexcept
+         : m_value( 0 ),
+           m_parent( parent )
+      {}
+
+      gauge( const gauge& ) = delete;
+      gauge( gauge&& ) = delete;
+      void operator=( const gauge& ) = delete;
+      void operator=( gauge&& ) = delete;
+
+      ~gauge() = default;
+
+      void add( const std::size_t bytes ) noexcept
+      {
+         m_value.fetch_add( bytes, std::memory_order_relaxed );
+         if( m_parent ) {
+            m_parent->add( bytes );
+         }
+      }
+
+      void sub( const std::size_t bytes ) noexcept
+      {
+         m_value.fetch_sub( bytes, std::memory_order_relaxed );
+         if( m_parent ) {
+            m_parent->sub( bytes );
+         }
+      }
+
+      [[nodiscard]] auto value() const noexcept -> std::size_t
+      {
+         return m_value.load( std::memory_order_relaxed );
+      }
+   };
+
+}  // namespace tao::pq::internal
+
+#endif
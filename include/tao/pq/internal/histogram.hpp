@@ -0,0 +1,65 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_HISTOGRAM_HPP
+#define TAO_PQ_INTERNAL_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <tao/pq/pool_statistics.hpp>
+
+namespace tao::pq::internal
+{
+   // lock-free latency histogram with exponential buckets from 16us to about 16s
+   class histogram final
+   {
+   public:
+      static constexpr std::size_t bounds = 21;
+
+   private:
+      std::array< std::atomic< std::size_t >, bounds + 1 > m_counts;
+      std::atomic< std::int64_t > m_sum;  // microseconds
+
+      [[nodiscard]] static constexpr auto bound( const std::size_t index ) noexcept -> std::int64_t
+      {
+         return std::int64_t( 16 ) << index;
+      }
+
+   public:
+      histogram() noexcept
+         : m_sum( 0 )
+      {
+         for( auto& c : m_counts ) {
+            c.store( 0, std::memory_order_relaxed );
+         }
+      }
+
+      histogram( const histogram& ) = delete;
+      histogram( histogram&& ) = delete;
+      void operator=( const histogram& ) = delete;
+      void operator=( histogram&& ) = delete;
+
+      ~histogram() = default;
+
+      void record( const std::chrono::steady_clock::duration d ) noexcept
+      {
+         const auto us = std::chrono::duration_cast< std::chrono::microseconds >( d ).count();
+         std::size_t index = 0;
+         while( ( index < bounds ) && ( us > bound( index ) ) ) {
+            ++index;
+         }
+         m_counts[ index ].fetch_add( 1, std::memory_order_relaxed );
+         m_sum.fetch_add( us, std::memory_order_relaxed );
+      }
+
+      [[nodiscard]] auto snapshot() const -> latency_histogram;
+   };
+
+}  // namespace tao::pq::internal
+
+#endif
@@ -0,0 +1,55 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_POLL_HPP
+#define TAO_PQ_INTERNAL_POLL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace tao::pq::internal
+{
+   enum class poll_status
+   {
+      timeout,
+      readable,
+      writable,
+      again
+   };
+
+   [[nodiscard]] auto errno_to_string( const int e ) -> std::string;
+
+   // remaining time in milliseconds, as expected by poll()
+   [[nodiscard]] inline auto poll_timeout( const std::chrono::steady_clock::time_point end ) noexcept -> int
+   {
+      const auto timeout = std::chrono::duration_cast< std::chrono::milliseconds >( end - std::chrono::steady_clock::now() ).count();
+      return ( timeout < 0 ) ? 0 : static_cast< int >( timeout );
+   }
+
+   // waits until the socket is readable (or writable, if requested),
+   // a negative timeout waits indefinitely, returns poll_status::again
+   // when interrupted, in which case the caller should simply retry
+   [[nodiscard]] auto poll( const int socket, const bool wait_for_write, const int timeout ) -> poll_status;
+
+   struct poll_item final
+   {
+      int socket;
+      bool wait_for_write;
+      poll_status status;
+   };
+
+   // waits until any of the sockets is ready, sets each item's status to readable, writable,
+   // or timeout if it is not ready, returns the number of ready sockets, 0 on timeout or when
+   // interrupted; errors on a socket are reported as readable to be detected by libpq
+   [[nodiscard]] auto poll( std::vector< poll_item >& items, const int timeout ) -> std::size_t;
+
+   // asks the kernel to busy poll the device queue when reading from the socket (SO_BUSY_POLL),
+   // this is a hint only and silently ignored where unsupported or not permitted
+   void set_busy_poll( const int socket, const std::chrono::microseconds timeout ) noexcept;
+
+}  // namespace tao::pq::internal
+
+#endif
@@ -5,12 +5,17 @@
 #ifndef TAO_PQ_INTERNAL_POOL_HPP
 #define TAO_PQ_INTERNAL_POOL_HPP
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <utility>
 
+#include <tao/pq/internal/histogram.hpp>
+
 namespace tao::pq::internal
 {
    template< typename T >
@@ -19,29 +24,66 @@ namespace tao::pq::internal
    {
    private:
       std::list< std::shared_ptr< T > > m_items;
-      std::mutex m_mutex;
+      mutable std::mutex m_mutex;
+
+      std::atomic< std::size_t > m_in_use;
+      std::atomic< std::size_t > m_created;
+      std::atomic< std::size_t > m_destroyed;
+      std::atomic< std::size_t > m_invalidated;
+      histogram m_hold_time;
 
       struct deleter final
       {
          std::weak_ptr< pool > m_pool;
+         std::shared_ptr< void > m_lease;  // released after the item was returned
+         std::chrono::steady_clock::time_point m_since;
 
          deleter() = default;
 
          explicit deleter( std::weak_ptr< pool >&& p ) noexcept
-            : m_pool( std::move( p ) )
+            : m_pool( std::move( p ) ),
+              m_since( std::chrono::steady_clock::now() )
          {}
 
          void operator()( T* item ) const noexcept
          {
             std::unique_ptr< T > up( item );
             if( const auto p = m_pool.lock() ) {
+               p->m_hold_time.record( std::chrono::steady_clock::now() - m_since );
+               p->m_in_use.fetch_sub( 1, std::memory_order_relaxed );
                p->push( up );
             }
          }
       };
 
+      void discard() noexcept
+      {
+         m_invalidated.fetch_add( 1, std::memory_order_relaxed );
+         m_destroyed.fetch_add( 1, std::memory_order_relaxed );
+      }
+
+      template< typename F >
+      [[nodiscard]] auto take( const F& f ) -> std::shared_ptr< T >
+      {
+         while( const auto sp = f() ) {
+            if( this->v_is_valid( *sp ) ) {
+               pool::attach( sp, this->weak_from_this() );
+               m_in_use.fetch_add( 1, std::memory_order_relaxed );
+               return sp;
+            }
+            discard();
+         }
+         return nullptr;
+      }
+
    protected:
-      pool() = default;
+      pool() noexcept
+         : m_in_use( 0 ),
+           m_created( 0 ),
+           m_destroyed( 0 ),
+           m_invalidated( 0 )
+      {}
+
       virtual ~pool() = default;
 
       // create a new T
@@ -56,6 +98,9 @@ namespace tao::pq::internal
             // potentially throws -> calls abort() due to noexcept!
             m_items.emplace_back( std::move( sp ) );
          }
+         else {
+            discard();
+         }
       }
 
       [[nodiscard]] auto pull() noexcept
@@ -69,6 +114,32 @@ namespace tao::pq::internal
          return nrv;
       }
 
+      template< typename F >
+      [[nodiscard]] auto pull_if( const F& f ) noexcept
+      {
+         std::shared_ptr< T > nrv;
+         const std::lock_guard lock( m_mutex );
+         for( auto it = m_items.rbegin(); it != m_items.rend(); ++it ) {
+            if( f( static_cast< const T& >( **it ) ) ) {
+               nrv = std::move( *it );
+               m_items.erase( std::next( it ).base() );
+               break;
+            }
+         }
+         return nrv;
+      }
+
+      [[nodiscard]] auto pull_oldest() noexcept
+      {
+         std::shared_ptr< T > nrv;
+         const std::lock_guard lock( m_mutex );
+         if( !m_items.empty() ) {
+            nrv = std::move( m_items.front() );
+            m_items.pop_front();
+         }
+         return nrv;
+      }
+
    public:
       pool( const pool& ) = delete;
       pool( pool&& ) = delete;
@@ -80,33 +151,119 @@ namespace tao::pq::internal
          deleter* d = std::get_deleter< deleter >( sp );
          assert( d );
          d->m_pool = std::move( p );
+         d->m_since = std::chrono::steady_clock::now();
       }
 
       static void detach( const std::shared_ptr< T >& sp ) noexcept
       {
          deleter* d = std::get_deleter< deleter >( sp );
          assert( d );
+         if( const auto p = d->m_pool.lock() ) {
+            p->m_in_use.fetch_sub( 1, std::memory_order_relaxed );
+         }
          d->m_pool.reset();
+         d->m_lease.reset();
+      }
+
+      // keeps the lease alive for as long as the item is borrowed
+      static void lease( const std::shared_ptr< T >& sp, std::shared_ptr< void >&& l ) noexcept
+      {
+         deleter* d = std::get_deleter< deleter >( sp );
+         assert( d );
+         d->m_lease = std::move( l );
+      }
+
+      // take ownership of a new T which is put into the pool when no longer used
+      [[nodiscard]] auto adopt( std::unique_ptr< T >&& up ) -> std::shared_ptr< T >
+      {
+         // the deleter is also called when allocating the control block fails
+         m_in_use.fetch_add( 1, std::memory_order_relaxed );
+         std::shared_ptr< T > sp( up.release(), pool::deleter( this->weak_from_this() ) );
+         m_created.fetch_add( 1, std::memory_order_relaxed );
+         return sp;
       }
 
       // create a new T which is put into the pool when no longer used
       [[nodiscard]] auto create() -> std::shared_ptr< T >
       {
-         return { v_create().release(), pool::deleter( this->weak_from_this() ) };
+         return adopt( v_create() );
+      }
+
+      // get an instance from the pool, returns an empty pointer if the pool is empty
+      [[nodiscard]] auto try_get() -> std::shared_ptr< T >
+      {
+         return take( [ this ] { return pull(); } );
+      }
+
+      // get the most recently used instance for which f returns true, returns an empty pointer if there is none
+      template< typename F >
+      [[nodiscard]] auto try_get_if( const F& f ) -> std::shared_ptr< T >
+      {
+         return take( [ & ] { return pull_if( f ); } );
+      }
+
+      // get the least recently used instance, returns an empty pointer if the pool is empty
+      [[nodiscard]] auto try_get_oldest() -> std::shared_ptr< T >
+      {
+         return take( [ this ] { return pull_oldest(); } );
       }
 
       // get an instance from the pool or create a new one if necessary
       [[nodiscard]] auto get() -> std::shared_ptr< T >
       {
-         while( const auto sp = pull() ) {
-            if( this->v_is_valid( *sp ) ) {
-               pool::attach( sp, this->weak_from_this() );
-               return sp;
-            }
+         if( auto sp = try_get() ) {
+            return sp;
          }
          return create();
       }
 
+      // the number of idle instances currently held by the pool
+      [[nodiscard]] auto size() const -> std::size_t
+      {
+         const std::lock_guard lock( m_mutex );
+         return m_items.size();
+      }
+
+      // the number of instances currently borrowed from the pool, detached instances are not included
+      [[nodiscard]] auto in_use() const noexcept -> std::size_t
+      {
+         return m_in_use.load( std::memory_order_relaxed );
+      }
+
+      [[nodiscard]] auto created() const noexcept -> std::size_t
+      {
+         return m_created.load( std::memory_order_relaxed );
+      }
+
+      // instances closed by the pool, including invalid ones
+      [[nodiscard]] auto destroyed() const noexcept -> std::size_t
+      {
+         return m_destroyed.load( std::memory_order_relaxed );
+      }
+
+      // instances discarded because they were found invalid
+      [[nodiscard]] auto invalidated() const noexcept -> std::size_t
+      {
+         return m_invalidated.load( std::memory_order_relaxed );
+      }
+
+      // the time instances were borrowed, recorded when they are returned
+      [[nodiscard]] auto hold_time() const -> latency_histogram
+      {
+         return m_hold_time.snapshot();
+      }
+
+      // closes the least recently used idle instances beyond the given number
+      void trim( const std::size_t max_idle )
+      {
+         std::list< std::shared_ptr< T > > deferred_delete;
+         const std::lock_guard lock( m_mutex );
+         while( m_items.size() > max_idle ) {
+            deferred_delete.splice( deferred_delete.end(), m_items, m_items.begin() );
+            m_destroyed.fetch_add( 1, std::memory_order_relaxed );
+         }
+      }
+
       void erase_invalid()
       {
          std::list< std::shared_ptr< T > > deferred_delete;
@@ -115,6 +272,7 @@ namespace tao::pq::internal
          while( it != m_items.end() ) {
             if( !this->v_is_valid( **it ) ) {
                deferred_delete.splice( deferred_delete.end(), m_items, it++ );
+               discard();
             }
             else {
                ++it;
@@ -0,0 +1,27 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_RESULT_FACTORY_HPP
+#define TAO_PQ_INTERNAL_RESULT_FACTORY_HPP
+
+#include <libpq-fe.h>
+
+#include <tao/pq/result.hpp>
+
+namespace tao::pq::internal
+{
+   // creates a result from a PGresult that was not received by a connection,
+   // e.g. one built with PQmakeEmptyPGresult() for benchmarks, takes ownership
+   class result_factory final
+   {
+   public:
+      [[nodiscard]] static auto create( PGresult* pgresult ) -> pq::result
+      {
+         return pq::result( pgresult );
+      }
+   };
+
+}  // namespace tao::pq::internal
+
+#endif
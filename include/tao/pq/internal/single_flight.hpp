@@ -0,0 +1,59 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_SINGLE_FLIGHT_HPP
+#define TAO_PQ_INTERNAL_SINGLE_FLIGHT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <tao/pq/result.hpp>
+
+namespace tao::pq::internal
+{
+   // concurrent calls with the same key share the result of the first call
+   class single_flight final
+   {
+   private:
+      std::mutex m_mutex;
+      std::unordered_map< std::string, std::shared_future< result > > m_in_flight;
+      std::atomic< std::size_t > m_hits;
+      std::atomic< std::size_t > m_misses;
+
+   public:
+      single_flight() noexcept
+         : m_hits( 0 ),
+           m_misses( 0 )
+      {}
+
+      single_flight( const single_flight& ) = delete;
+      single_flight( single_flight&& ) = delete;
+      void operator=( const single_flight& ) = delete;
+      void operator=( single_flight&& ) = delete;
+
+      ~single_flight() = default;
+
+      [[nodiscard]] auto execute( const std::string& key, const std::function< result() >& f ) -> result;
+
+      // number of calls which shared the result of a call in flight
+      [[nodiscard]] auto hits() const noexcept -> std::size_t
+      {
+         return m_hits.load( std::memory_order_relaxed );
+      }
+
+      // number of calls which executed the statement themselves
+      [[nodiscard]] auto misses() const noexcept -> std::size_t
+      {
+         return m_misses.load( std::memory_order_relaxed );
+      }
+   };
+
+}  // namespace tao::pq::internal
+
+#endif
@@ -0,0 +1,62 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_STATEMENT_KEY_HPP
+#define TAO_PQ_INTERNAL_STATEMENT_KEY_HPP
+
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <tao/pq/internal/gen.hpp>
+#include <tao/pq/oid.hpp>
+#include <tao/pq/parameter_traits.hpp>
+
+namespace tao::pq::internal
+{
+   // an unambiguous binary encoding of a statement and its parameters,
+   // two statements with equal keys send identical messages to the server
+   [[nodiscard]] auto statement_key( const char* statement,
+                                     const int n_params,
+                                     const Oid types[],
+                                     const char* const values[],
+                                     const int lengths[],
+                                     const int formats[] ) -> std::string;
+
+   template< std::size_t... Os, std::size_t... Is, typename... Ts >
+   [[nodiscard]] auto statement_key_indexed( const char* statement,
+                                             std::index_sequence< Os... > /*unused*/,
+                                             std::index_sequence< Is... > /*unused*/,
+                                             const std::tuple< Ts... >& tuple ) -> std::string
+   {
+      const Oid types[] = { static_cast< Oid >( std::get< Os >( tuple ).template type< Is >() )... };
+      const char* const values[] = { std::get< Os >( tuple ).template value< Is >()... };
+      const int lengths[] = { std::get< Os >( tuple ).template length< Is >()... };
+      const int formats[] = { std::get< Os >( tuple ).template format< Is >()... };
+      return internal::statement_key( statement, sizeof...( Os ), types, values, lengths, formats );
+   }
+
+   template< typename... Ts >
+   [[nodiscard]] auto statement_key_traits( const char* statement, const Ts&... ts ) -> std::string
+   {
+      using gen = internal::gen< Ts::columns... >;
+      return internal::statement_key_indexed( statement, typename gen::outer_sequence(), typename gen::inner_sequence(), std::tie( ts... ) );
+   }
+
+   template< typename... As >
+   [[nodiscard]] auto make_statement_key( const char* statement, const As&... as ) -> std::string
+   {
+      if constexpr( sizeof...( As ) == 0 ) {
+         return internal::statement_key( statement, 0, nullptr, nullptr, nullptr, nullptr );
+      }
+      else {
+         return internal::statement_key_traits( statement, parameter_traits< As >( as )... );
+      }
+   }
+
+}  // namespace tao::pq::internal
+
+#endif
@@ -0,0 +1,17 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_TABLE_READER_PARSE_HPP
+#define TAO_PQ_INTERNAL_TABLE_READER_PARSE_HPP
+
+#include <vector>
+
+namespace tao::pq::internal
+{
+   // parses a null-terminated row in COPY text format in place, NULL values are returned as nullptr
+   [[nodiscard]] auto table_reader_parse( char* read, std::vector< const char* >& data ) noexcept -> bool;
+
+}  // namespace tao::pq::internal
+
+#endif
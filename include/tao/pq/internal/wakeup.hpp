@@ -0,0 +1,40 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_INTERNAL_WAKEUP_HPP
+#define TAO_PQ_INTERNAL_WAKEUP_HPP
+
+namespace tao::pq::internal
+{
+   // a non-blocking pipe to wake up a thread waiting in poll() from another thread,
+   // WSAPoll() only supports sockets, so on Windows socket() returns -1 and callers
+   // have to check periodically instead
+   class wakeup final
+   {
+   private:
+      int m_fds[ 2 ];
+
+   public:
+      wakeup();
+
+      wakeup( const wakeup& ) = delete;
+      wakeup( wakeup&& ) = delete;
+      void operator=( const wakeup& ) = delete;
+      void operator=( wakeup&& ) = delete;
+
+      ~wakeup();
+
+      // readable after notify() was called, until clear() is called
+      [[nodiscard]] auto socket() const noexcept -> int
+      {
+         return m_fds[ 0 ];
+      }
+
+      void notify() noexcept;
+      void clear() noexcept;
+   };
+
+}  // namespace tao::pq::internal
+
+#endif
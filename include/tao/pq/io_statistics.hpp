@@ -0,0 +1,26 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_IO_STATISTICS_HPP
+#define TAO_PQ_IO_STATISTICS_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace tao::pq
+{
+   struct io_statistics
+   {
+      std::size_t statements = 0;               // sent, including deferred and prepared statements
+      std::size_t round_trips = 0;              // waits for a response after sending
+      std::size_t waits = 0;                    // calls to poll()
+      std::chrono::microseconds wait_time{};    // time blocked in poll()
+      std::size_t flush_retries = 0;            // the socket's send buffer was full
+      std::size_t bytes_sent = 0;               // statements, parameter values and COPY data
+      std::size_t bytes_received = 0;           // memory of the results and COPY data
+   };
+
+}  // namespace tao::pq
+
+#endif
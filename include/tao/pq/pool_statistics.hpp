@@ -0,0 +1,43 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_POOL_STATISTICS_HPP
+#define TAO_PQ_POOL_STATISTICS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tao::pq
+{
+   struct latency_histogram
+   {
+      std::vector< std::chrono::microseconds > bounds;  // upper bounds, the last bucket is unbounded
+      std::vector< std::size_t > counts;                // one more than bounds, not cumulative
+      std::size_t count = 0;
+      std::chrono::microseconds sum{};
+   };
+
+   struct pool_statistics
+   {
+      std::size_t idle = 0;
+      std::size_t in_use = 0;
+      std::size_t total = 0;
+      std::size_t created = 0;
+      std::size_t destroyed = 0;
+      std::size_t invalidated = 0;    // found in a failed state, included in destroyed
+      std::size_t result_memory = 0;  // bytes held by live results
+
+      latency_histogram checkout_latency;
+      latency_histogram hold_time;
+   };
+
+   // Prometheus text exposition format, labels are added to each sample, e.g. pool="main"
+   [[nodiscard]] auto to_prometheus( const pool_statistics& s, const std::string_view name = "taopq_pool", const std::string_view labels = "" ) -> std::string;
+
+}  // namespace tao::pq
+
+#endif
@@ -28,12 +28,17 @@
 namespace tao::pq
 {
    class connection;
+   class shared_connection;
    class table_reader;
    class table_writer;
    class transaction;
 
    namespace internal
    {
+      class async_base;
+      class gauge;
+      class result_factory;
+
       template< typename T, typename = void >
       inline constexpr bool has_reserve = false;
 
@@ -46,10 +51,14 @@ namespace tao::pq
    {
    private:
       friend class connection;
+      friend class shared_connection;
       friend class table_reader;
       friend class table_writer;
       friend class transaction;
 
+      friend class internal::async_base;
+      friend class internal::result_factory;
+
       const std::shared_ptr< PGresult > m_pgresult;
       const std::size_t m_columns;
       const std::size_t m_rows;
@@ -57,7 +66,8 @@ namespace tao::pq
       void check_has_result_set() const;
       void check_row( const std::size_t row ) const;
 
-      explicit result( PGresult* pgresult );
+      // the memory of the result is accounted in the gauge for as long as the result is alive
+      explicit result( PGresult* pgresult, const std::shared_ptr< internal::gauge >& gauge = nullptr );
 
    public:
       [[nodiscard]] auto has_rows_affected() const noexcept -> bool;
@@ -74,6 +84,12 @@ namespace tao::pq
       [[nodiscard]] auto empty() const -> bool;
       [[nodiscard]] auto size() const -> std::size_t;
 
+      // bytes allocated by libpq for the result
+      [[nodiscard]] auto memory_size() const noexcept -> std::size_t
+      {
+         return PQresultMemorySize( m_pgresult.get() );
+      }
+
    private:
       class const_iterator
          : private row
@@ -0,0 +1,152 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_RESULT_CACHE_HPP
+#define TAO_PQ_RESULT_CACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/internal/statement_key.hpp>
+#include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/result.hpp>
+
+namespace tao::pq
+{
+   // caches results of read-only statements executed on a connection pool,
+   // entries are evicted when their TTL expired, when the memory bound is
+   // exceeded, or when a notification arrives on one of their channels
+   class result_cache final
+   {
+   private:
+      struct entry final
+      {
+         const pq::result result;
+         const std::chrono::steady_clock::time_point expires;
+         const std::size_t size;
+         const std::vector< std::string > channels;
+         std::list< const std::string* >::iterator lru;
+
+         entry( const pq::result& r, const std::chrono::steady_clock::time_point e, const std::size_t s, const std::vector< std::string >& c )
+            : result( r ),
+              expires( e ),
+              size( s ),
+              channels( c )
+         {}
+      };
+
+      struct channel_state final
+      {
+         std::uint64_t generation = 0;
+         std::set< const std::string* > keys;
+      };
+
+      const std::shared_ptr< connection_pool > m_pool;
+      const std::chrono::milliseconds m_ttl;
+      const std::size_t m_max_memory;
+
+      std::mutex m_listener_mutex;
+      std::shared_ptr< pq::connection > m_listener;
+      std::set< std::string, std::less<> > m_listening;
+
+      mutable std::mutex m_mutex;
+      std::unordered_map< std::string, entry > m_entries;
+      std::list< const std::string* > m_lru;  // most recently used first
+      std::map< std::string, channel_state, std::less<> > m_channels;
+      std::uint64_t m_epoch;
+      std::size_t m_memory;
+
+      std::atomic< std::size_t > m_hits;
+      std::atomic< std::size_t > m_misses;
+
+      [[nodiscard]] auto lookup( const std::vector< std::string >& channels, std::string&& key, const std::function< result() >& f ) -> result;
+
+      void listen( const std::vector< std::string >& channels );
+      void poll_notifications() noexcept;
+      void drain_notifications() noexcept;
+
+      void erase( const std::unordered_map< std::string, entry >::iterator it ) noexcept;
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class result_cache;
+      };
+
+   public:
+      result_cache( const private_key /*unused*/, const std::shared_ptr< connection_pool >& pool, const std::chrono::milliseconds ttl, const std::size_t max_memory );
+
+      result_cache( const result_cache& ) = delete;
+      result_cache( result_cache&& ) = delete;
+      void operator=( const result_cache& ) = delete;
+      void operator=( result_cache&& ) = delete;
+
+      ~result_cache() = default;
+
+      [[nodiscard]] static auto create( const std::shared_ptr< connection_pool >& pool, const std::chrono::milliseconds ttl, const std::size_t max_memory ) -> std::shared_ptr< result_cache >;
+
+      [[nodiscard]] auto pool() const noexcept -> const std::shared_ptr< connection_pool >&
+      {
+         return m_pool;
+      }
+
+      [[nodiscard]] auto ttl() const noexcept -> std::chrono::milliseconds
+      {
+         return m_ttl;
+      }
+
+      [[nodiscard]] auto max_memory() const noexcept -> std::size_t
+      {
+         return m_max_memory;
+      }
+
+      // returns a cached result or executes the statement on the pool, a notification
+      // on any of the channels evicts the entry, only use this for read-only statements
+      template< typename... As >
+      auto execute( const std::vector< std::string >& channels, const internal::zsv statement, As&&... as ) -> result
+      {
+         return result_cache::lookup( channels, internal::make_statement_key( statement, as... ), [ & ] { return m_pool->execute( statement, std::forward< As >( as )... ); } );
+      }
+
+      void invalidate( const std::string_view channel );
+      void clear() noexcept;
+
+      // processes the notifications received so far, this also happens on each lookup
+      void handle_notifications();
+
+      [[nodiscard]] auto hits() const noexcept -> std::size_t
+      {
+         return m_hits.load( std::memory_order_relaxed );
+      }
+
+      [[nodiscard]] auto misses() const noexcept -> std::size_t
+      {
+         return m_misses.load( std::memory_order_relaxed );
+      }
+
+      [[nodiscard]] auto hit_rate() const noexcept -> double;
+
+      [[nodiscard]] auto size() const -> std::size_t;
+      [[nodiscard]] auto memory_usage() const -> std::size_t;
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,107 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_ROUTING_POOL_HPP
+#define TAO_PQ_ROUTING_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <tao/pq/access_mode.hpp>
+#include <tao/pq/connection.hpp>
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/isolation_level.hpp>
+#include <tao/pq/transaction.hpp>
+
+namespace tao::pq
+{
+   // routes read-write work to a primary and read-only work to replicas
+   class routing_pool final
+   {
+   private:
+      struct node;
+
+      const std::shared_ptr< connection_pool > m_primary;
+      std::vector< std::unique_ptr< node > > m_replicas;
+      std::atomic< std::chrono::milliseconds > m_replay_timeout;
+
+      // borrows a connection from a replica, or from the primary if no replica is usable
+      [[nodiscard]] auto replica_connection( const std::optional< std::string_view >& min_lsn ) -> std::pair< std::shared_ptr< pq::connection >, node* >;
+      [[nodiscard]] auto read_only_transaction( const isolation_level il, const std::optional< std::string_view >& min_lsn ) -> std::shared_ptr< pq::transaction >;
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class routing_pool;
+      };
+
+   public:
+      routing_pool( const private_key /*unused*/, const std::shared_ptr< connection_pool >& primary, const std::vector< std::shared_ptr< connection_pool > >& replicas );
+
+      routing_pool( const routing_pool& ) = delete;
+      routing_pool( routing_pool&& ) = delete;
+      void operator=( const routing_pool& ) = delete;
+      void operator=( routing_pool&& ) = delete;
+
+      ~routing_pool();
+
+      [[nodiscard]] static auto create( const std::shared_ptr< connection_pool >& primary, const std::vector< std::shared_ptr< connection_pool > >& replicas ) -> std::shared_ptr< routing_pool >;
+      [[nodiscard]] static auto create( const std::string_view primary_info, const std::vector< std::string >& replica_infos ) -> std::shared_ptr< routing_pool >;
+
+      [[nodiscard]] auto primary() const noexcept -> const std::shared_ptr< connection_pool >&
+      {
+         return m_primary;
+      }
+
+      [[nodiscard]] auto replicas() const noexcept -> std::size_t
+      {
+         return m_replicas.size();
+      }
+
+      [[nodiscard]] auto replica( const std::size_t index ) const -> const std::shared_ptr< connection_pool >&;
+
+      // smoothed latency of a replica, as observed when starting read-only transactions
+      [[nodiscard]] auto replica_latency( const std::size_t index ) const -> std::chrono::microseconds;
+
+      [[nodiscard]] auto replay_timeout() const noexcept -> std::chrono::milliseconds
+      {
+         return m_replay_timeout.load( std::memory_order_relaxed );
+      }
+
+      void set_replay_timeout( const std::chrono::milliseconds timeout ) noexcept;
+
+      // read-only connections are borrowed from a replica, if available
+      [[nodiscard]] auto connection( const access_mode am = access_mode::default_access_mode ) -> std::shared_ptr< pq::connection >;
+
+      // a connection from a replica that replayed the given LSN, or from the primary
+      [[nodiscard]] auto connection( const std::string_view min_lsn ) -> std::shared_ptr< pq::connection >;
+
+      [[nodiscard]] auto transaction( const access_mode am = access_mode::default_access_mode, const isolation_level il = isolation_level::default_isolation_level ) -> std::shared_ptr< pq::transaction >;
+      [[nodiscard]] auto transaction( const isolation_level il, const access_mode am = access_mode::default_access_mode ) -> std::shared_ptr< pq::transaction >;
+
+      // a read-only transaction which sees at least all changes up to the given LSN
+      [[nodiscard]] auto transaction( const std::string_view min_lsn, const isolation_level il = isolation_level::default_isolation_level ) -> std::shared_ptr< pq::transaction >;
+
+      // the current WAL position of the primary, to be used as min_lsn after a write
+      [[nodiscard]] auto primary_lsn() -> std::string;
+
+      template< typename... As >
+      auto execute( const internal::zsv statement, As&&... as )
+      {
+         return m_primary->execute( statement, std::forward< As >( as )... );
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,167 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_SCATTER_GATHER_HPP
+#define TAO_PQ_SCATTER_GATHER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/result.hpp>
+#include <tao/pq/row.hpp>
+#include <tao/pq/transaction.hpp>
+
+namespace tao::pq
+{
+   // executes statements concurrently on multiple connection pools
+   class scatter_gather final
+   {
+   public:
+      struct target_result
+      {
+         std::optional< pq::result > result;  // empty if the target failed
+         std::exception_ptr error;
+         std::chrono::microseconds latency{};
+
+         [[nodiscard]] explicit operator bool() const noexcept
+         {
+            return result.has_value();
+         }
+      };
+
+   private:
+      using job = std::pair< std::shared_ptr< connection_pool >, std::function< void( transaction& ) > >;
+
+      const std::vector< std::shared_ptr< connection_pool > > m_pools;
+      std::optional< std::chrono::milliseconds > m_timeout;
+
+      void run( const std::vector< job >& jobs, const std::function< void( std::size_t, target_result&& ) >& f ) const;
+
+      [[nodiscard]] auto gather( const std::vector< job >& jobs ) const -> std::vector< target_result >;
+
+      template< typename... As >
+      [[nodiscard]] auto broadcast( const internal::zsv statement, const As&... as ) const -> std::vector< job >
+      {
+         std::vector< job > jobs;
+         jobs.reserve( m_pools.size() );
+         for( const auto& pool : m_pools ) {
+            jobs.emplace_back( pool, [ statement, &as... ]( transaction& tr ) { tr.send( statement, as... ); } );
+         }
+         return jobs;
+      }
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class scatter_gather;
+      };
+
+   public:
+      scatter_gather( const private_key /*unused*/, const std::vector< std::shared_ptr< connection_pool > >& pools );
+
+      scatter_gather( const scatter_gather& ) = delete;
+      scatter_gather( scatter_gather&& ) = delete;
+      void operator=( const scatter_gather& ) = delete;
+      void operator=( scatter_gather&& ) = delete;
+
+      ~scatter_gather() = default;
+
+      [[nodiscard]] static auto create( const std::vector< std::shared_ptr< connection_pool > >& pools ) -> std::shared_ptr< scatter_gather >;
+
+      [[nodiscard]] auto pools() const noexcept -> const std::vector< std::shared_ptr< connection_pool > >&
+      {
+         return m_pools;
+      }
+
+      // the timeout applies to each target individually
+      [[nodiscard]] decltype( auto ) timeout() const noexcept
+      {
+         return m_timeout;
+      }
+
+      void set_timeout( const std::chrono::milliseconds timeout );
+      void reset_timeout() noexcept;
+
+      // executes the statement on all pools, the results are in the order of the pools
+      template< typename... As >
+      [[nodiscard]] auto execute( const internal::zsv statement, const As&... as ) const -> std::vector< target_result >
+      {
+         return scatter_gather::gather( scatter_gather::broadcast( statement, as... ) );
+      }
+
+      // executes the statement on all pools, f is called with the index of the pool and
+      // its result as soon as the result is available
+      template< typename F, typename... As >
+      void stream( const F& f, const internal::zsv statement, const As&... as ) const
+      {
+         scatter_gather::run( scatter_gather::broadcast( statement, as... ), f );
+      }
+
+      // executes the statement once per partition with the partition as the first parameter,
+      // partition i is executed on pool i % pools().size(), the results are in the order of the partitions
+      template< typename P, typename... As >
+      [[nodiscard]] auto execute_partitioned( const internal::zsv statement, const std::vector< P >& partitions, const As&... as ) const -> std::vector< target_result >
+      {
+         std::vector< job > jobs;
+         jobs.reserve( partitions.size() );
+         for( std::size_t i = 0; i < partitions.size(); ++i ) {
+            jobs.emplace_back( m_pools[ i % m_pools.size() ], [ &, i ]( transaction& tr ) { tr.send( statement, partitions[ i ], as... ); } );
+         }
+         return scatter_gather::gather( jobs );
+      }
+
+      [[nodiscard]] static auto failures( const std::vector< target_result >& results ) noexcept -> std::size_t;
+
+      // rethrows the first error, if any
+      static void check( const std::vector< target_result >& results );
+
+      // k-way merge of the successful results, each of which must be sorted by the given column,
+      // f is called for each row in the order given by compare applied to the column's values
+      template< typename T, typename F, typename Compare = std::less<> >
+      static void merge( const std::vector< target_result >& results, const internal::zsv column, const F& f, const Compare& compare = Compare() )
+      {
+         using item = std::tuple< T, std::size_t, std::size_t >;  // value, target, row
+         std::vector< std::size_t > columns( results.size() );
+         const auto greater = [ & ]( const item& lhs, const item& rhs ) {
+            if( compare( std::get< 0 >( rhs ), std::get< 0 >( lhs ) ) ) {
+               return true;
+            }
+            if( compare( std::get< 0 >( lhs ), std::get< 0 >( rhs ) ) ) {
+               return false;
+            }
+            return std::get< 1 >( lhs ) > std::get< 1 >( rhs );  // stable with respect to the targets
+         };
+         std::priority_queue< item, std::vector< item >, decltype( greater ) > heap( greater );
+         for( std::size_t i = 0; i < results.size(); ++i ) {
+            if( const auto& r = results[ i ].result; r && !r->empty() ) {
+               columns[ i ] = r->index( column );
+               heap.emplace( ( *r )[ 0 ].template get< T >( columns[ i ] ), i, 0 );
+            }
+         }
+         while( !heap.empty() ) {
+            const auto [ value, target, row ] = heap.top();
+            heap.pop();
+            const auto& r = *results[ target ].result;
+            f( r[ row ] );
+            if( row + 1 < r.size() ) {
+               heap.emplace( r[ row + 1 ].template get< T >( columns[ target ] ), target, row + 1 );
+            }
+         }
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,47 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_SCHEDULER_HPP
+#define TAO_PQ_SCHEDULER_HPP
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include <tao/pq/internal/poll.hpp>
+
+namespace tao::pq
+{
+   // waits for socket readiness on behalf of asynchronous operations,
+   // implemented by tao::pq::event_loop or by an application's own loop
+   class scheduler
+   {
+   public:
+      using ready_handler = std::function< void( const internal::poll_status ) >;
+
+   protected:
+      scheduler() = default;
+
+      virtual void v_watch( const int socket, const bool wait_for_write, ready_handler handler, const std::optional< std::chrono::steady_clock::time_point >& end ) = 0;
+
+   public:
+      virtual ~scheduler() = default;
+
+      scheduler( const scheduler& ) = delete;
+      scheduler( scheduler&& ) = delete;
+      void operator=( const scheduler& ) = delete;
+      void operator=( scheduler&& ) = delete;
+
+      // calls the handler once when the socket is ready, or with poll_status::timeout when the end is reached,
+      // watching a socket again replaces the previous handler
+      void watch( const int socket, const bool wait_for_write, ready_handler handler, const std::optional< std::chrono::steady_clock::time_point >& end = std::nullopt )
+      {
+         v_watch( socket, wait_for_write, std::move( handler ), end );
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
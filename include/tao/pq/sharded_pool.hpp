@@ -0,0 +1,102 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_SHARDED_POOL_HPP
+#define TAO_PQ_SHARDED_POOL_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <tao/pq/access_mode.hpp>
+#include <tao/pq/connection.hpp>
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/isolation_level.hpp>
+#include <tao/pq/transaction.hpp>
+
+namespace tao::pq
+{
+   struct shard_statistics
+   {
+      std::string name;
+      std::size_t requests = 0;
+      std::size_t idle_connections = 0;
+      std::size_t virtual_nodes = 0;
+   };
+
+   // maps shard keys to connection pools using consistent hashing with virtual nodes
+   class sharded_pool final
+   {
+   private:
+      struct shard;
+      struct ring;
+
+      const std::size_t m_virtual_nodes;
+
+      mutable std::mutex m_mutex;
+      std::shared_ptr< const ring > m_ring;
+
+      [[nodiscard]] auto snapshot() const -> std::shared_ptr< const ring >;
+      [[nodiscard]] auto find( const std::string_view key ) const -> std::shared_ptr< shard >;
+
+      void update( std::map< std::string, std::shared_ptr< connection_pool >, std::less<> >&& pools );
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class sharded_pool;
+      };
+
+   public:
+      sharded_pool( const private_key /*unused*/, const std::size_t virtual_nodes );
+
+      sharded_pool( const sharded_pool& ) = delete;
+      sharded_pool( sharded_pool&& ) = delete;
+      void operator=( const sharded_pool& ) = delete;
+      void operator=( sharded_pool&& ) = delete;
+
+      ~sharded_pool();
+
+      [[nodiscard]] static auto create( const std::size_t virtual_nodes = 128 ) -> std::shared_ptr< sharded_pool >;
+
+      [[nodiscard]] auto virtual_nodes() const noexcept -> std::size_t
+      {
+         return m_virtual_nodes;
+      }
+
+      // changing the shard map does not affect connections which are currently borrowed
+      void add_shard( const std::string_view name, const std::shared_ptr< connection_pool >& pool );
+      void add_shard( const std::string_view name, const std::string_view connection_info );
+      void remove_shard( const std::string_view name );
+      void rebalance( const std::map< std::string, std::shared_ptr< connection_pool >, std::less<> >& pools );
+
+      [[nodiscard]] auto shards() const -> std::vector< std::string >;
+
+      [[nodiscard]] auto shard_name( const std::string_view key ) const -> std::string;
+      [[nodiscard]] auto pool( const std::string_view key ) const -> std::shared_ptr< connection_pool >;
+
+      [[nodiscard]] auto connection( const std::string_view key ) -> std::shared_ptr< pq::connection >;
+
+      [[nodiscard]] auto transaction( const std::string_view key, const access_mode am = access_mode::default_access_mode, const isolation_level il = isolation_level::default_isolation_level ) -> std::shared_ptr< pq::transaction >;
+      [[nodiscard]] auto transaction( const std::string_view key, const isolation_level il, const access_mode am = access_mode::default_access_mode ) -> std::shared_ptr< pq::transaction >;
+
+      template< typename... As >
+      auto execute( const std::string_view key, const internal::zsv statement, As&&... as )
+      {
+         return sharded_pool::connection( key )->direct()->execute( statement, std::forward< As >( as )... );
+      }
+
+      [[nodiscard]] auto statistics() const -> std::vector< shard_statistics >;
+   };
+
+}  // namespace tao::pq
+
+#endif
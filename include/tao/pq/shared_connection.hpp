@@ -0,0 +1,131 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_SHARED_CONNECTION_HPP
+#define TAO_PQ_SHARED_CONNECTION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <tao/pq/internal/gen.hpp>
+#include <tao/pq/internal/zsv.hpp>
+#include <tao/pq/oid.hpp>
+#include <tao/pq/parameter_traits.hpp>
+#include <tao/pq/result.hpp>
+
+namespace tao::pq
+{
+   class connection;
+
+   namespace internal
+   {
+      class wakeup;
+
+   }  // namespace internal
+
+   // a connection that can be used by many threads at once, the statements
+   // are queued and pipelined over a single connection by a driver thread
+   class shared_connection final
+   {
+   private:
+      struct request;
+
+      const std::string m_connection_info;
+      std::atomic< std::chrono::milliseconds::rep > m_timeout;  // zero for none
+      std::shared_ptr< pq::connection > m_connection;  // owned by the driver thread, empty after it broke
+      const std::unique_ptr< internal::wakeup > m_wakeup;
+
+      std::atomic< request* > m_queue;
+      std::atomic< bool > m_waiting;
+      std::atomic< bool > m_polling;
+      std::atomic< bool > m_stopping;
+      std::mutex m_mutex;
+      std::condition_variable m_condition;
+      std::thread m_driver;
+
+      [[nodiscard]] auto enqueue( const char* statement,
+                                  const int n_params,
+                                  const Oid types[],
+                                  const char* const values[],
+                                  const int lengths[],
+                                  const int formats[] ) -> std::future< result >;
+
+      [[nodiscard]] auto dequeue() noexcept -> request*;
+
+      [[nodiscard]] auto open() const -> std::shared_ptr< pq::connection >;
+
+      void run() noexcept;
+
+      template< std::size_t... Os, std::size_t... Is, typename... Ts >
+      [[nodiscard]] auto execute_indexed( const char* statement,
+                                          std::index_sequence< Os... > /*unused*/,
+                                          std::index_sequence< Is... > /*unused*/,
+                                          const std::tuple< Ts... >& tuple ) -> std::future< result >
+      {
+         const Oid types[] = { static_cast< Oid >( std::get< Os >( tuple ).template type< Is >() )... };
+         const char* const values[] = { std::get< Os >( tuple ).template value< Is >()... };
+         const int lengths[] = { std::get< Os >( tuple ).template length< Is >()... };
+         const int formats[] = { std::get< Os >( tuple ).template format< Is >()... };
+         return shared_connection::enqueue( statement, sizeof...( Os ), types, values, lengths, formats );
+      }
+
+      template< typename... Ts >
+      [[nodiscard]] auto execute_traits( const char* statement, const Ts&... ts ) -> std::future< result >
+      {
+         using gen = internal::gen< Ts::columns... >;
+         return shared_connection::execute_indexed( statement, typename gen::outer_sequence(), typename gen::inner_sequence(), std::tie( ts... ) );
+      }
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class shared_connection;
+      };
+
+   public:
+      shared_connection( const private_key /*unused*/, const std::string& connection_info );
+
+      shared_connection( const shared_connection& ) = delete;
+      shared_connection( shared_connection&& ) = delete;
+      void operator=( const shared_connection& ) = delete;
+      void operator=( shared_connection&& ) = delete;
+
+      // completes all queued statements
+      ~shared_connection();
+
+      [[nodiscard]] static auto create( const std::string& connection_info ) -> std::shared_ptr< shared_connection >;
+
+      // limits how long the driver waits for the next result, or for a new connection
+      [[nodiscard]] auto timeout() const noexcept -> std::optional< std::chrono::milliseconds >;
+      void set_timeout( const std::chrono::milliseconds timeout );
+      void reset_timeout() noexcept;
+
+      // the parameters are copied, the statement is executed in its own implicit transaction
+      template< typename... As >
+      [[nodiscard]] auto execute( const internal::zsv statement, As&&... as ) -> std::future< result >
+      {
+         if constexpr( sizeof...( As ) == 0 ) {
+            return shared_connection::enqueue( statement, 0, nullptr, nullptr, nullptr, nullptr );
+         }
+         else {
+            return shared_connection::execute_traits( statement, parameter_traits< std::decay_t< As > >( std::forward< As >( as ) )... );
+         }
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_SLOW_QUERY_LOG_HPP
+#define TAO_PQ_SLOW_QUERY_LOG_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <tao/pq/statement_hooks.hpp>
+
+namespace tao::pq
+{
+   class connection_pool;
+
+   struct slow_query
+   {
+      statement_event event;
+      std::chrono::microseconds duration{};
+      std::chrono::system_clock::time_point captured;
+      std::optional< std::string > plan;  // EXPLAIN in JSON format, if sampled and successful
+   };
+
+   // keeps the most recent statements that exceeded a threshold in a ring buffer
+   class slow_query_log final
+      : public statement_hooks
+   {
+   private:
+      const std::chrono::microseconds m_threshold;
+      const std::size_t m_capacity;
+
+      struct pending
+      {
+         std::size_t id;  // the number of statements captured before
+         statement_event event;
+      };
+
+      mutable std::mutex m_mutex;
+      std::vector< slow_query > m_entries;
+      std::size_t m_next = 0;
+      std::size_t m_captured = 0;
+      std::size_t m_first = 0;  // the id of the first entry after clear()
+
+      std::shared_ptr< connection_pool > m_explain_pool;
+      std::chrono::milliseconds m_explain_timeout{};
+      double m_sample_rate = 0.0;
+      double m_credit = 0.0;
+      std::vector< pending > m_pending;
+
+      [[nodiscard]] auto find( const std::size_t id ) noexcept -> slow_query*;
+      [[nodiscard]] static auto explain( connection_pool& pool, const statement_event& e, const std::chrono::milliseconds timeout ) noexcept -> std::optional< std::string >;
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class slow_query_log;
+      };
+
+   public:
+      slow_query_log( const private_key /*unused*/, const std::chrono::microseconds threshold, const std::size_t capacity );
+
+      slow_query_log( const slow_query_log& ) = delete;
+      slow_query_log( slow_query_log&& ) = delete;
+      void operator=( const slow_query_log& ) = delete;
+      void operator=( slow_query_log&& ) = delete;
+
+      ~slow_query_log() override = default;
+
+      [[nodiscard]] static auto create( const std::chrono::microseconds threshold, const std::size_t capacity = 100 ) -> std::shared_ptr< slow_query_log >;
+
+      [[nodiscard]] auto threshold() const noexcept -> std::chrono::microseconds
+      {
+         return m_threshold;
+      }
+
+      [[nodiscard]] auto capacity() const noexcept -> std::size_t
+      {
+         return m_capacity;
+      }
+
+      // selects a fraction of the captured statements to be explained on a connection of the given pool
+      void set_explain( const std::shared_ptr< connection_pool >& pool, const double sample_rate = 1.0, const std::chrono::milliseconds timeout = std::chrono::seconds( 1 ) );
+      void reset_explain() noexcept;
+
+      // runs EXPLAIN for the selected statements and fills in the plans of their entries,
+      // returns the number of statements processed; blocks, so never call it from a hook
+      auto explain_pending() -> std::size_t;
+
+      void on_result( const statement_event& e ) override;
+
+      // the entries in the ring buffer, the oldest first
+      [[nodiscard]] auto entries() const -> std::vector< slow_query >;
+
+      // the number of statements captured, including those no longer in the ring buffer
+      [[nodiscard]] auto captured() const noexcept -> std::size_t;
+
+      void clear() noexcept;
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,126 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_STATEMENT_HOOKS_HPP
+#define TAO_PQ_STATEMENT_HOOKS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tao/pq/oid.hpp>
+
+namespace tao::pq
+{
+   struct statement_event
+   {
+      std::string statement;  // the statement or the name of the prepared statement
+      bool prepared = false;
+      int parameters = 0;
+      std::vector< oid > types;        // of the parameters, oid::invalid if inferred by the server
+      std::size_t bytes_sent = 0;      // statement, parameter values and COPY data
+      std::size_t bytes_received = 0;  // field values of the result and COPY data
+      std::size_t rows = 0;            // rows returned, or affected if none were returned
+      bool failed = false;             // the statement failed or reached a timeout
+
+      std::chrono::steady_clock::time_point start;       // the statement is handed to libpq
+      std::chrono::steady_clock::time_point sent;        // the statement was flushed to the socket
+      std::chrono::steady_clock::time_point first_byte;  // the first response data arrived
+      std::chrono::steady_clock::time_point done;        // the result is complete
+   };
+
+   // observes the statements executed on a connection, the time points
+   // not reached yet are default constructed, hooks should not throw
+   class statement_hooks
+   {
+   public:
+      statement_hooks() = default;
+      virtual ~statement_hooks() = default;
+
+      statement_hooks( const statement_hooks& ) = delete;
+      statement_hooks( statement_hooks&& ) = delete;
+      void operator=( const statement_hooks& ) = delete;
+      void operator=( statement_hooks&& ) = delete;
+
+      virtual void on_start( const statement_event& /*unused*/ ) {}
+      virtual void on_sent( const statement_event& /*unused*/ ) {}
+      virtual void on_first_byte( const statement_event& /*unused*/ ) {}
+      virtual void on_result( const statement_event& /*unused*/ ) {}
+   };
+
+   // forwards the events to several hooks in the given order, e.g. to combine the statement
+   // statistics, the slow query log and your own tracing on a connection, null pointers are ignored
+   class statement_hooks_list final
+      : public statement_hooks
+   {
+   private:
+      std::vector< std::shared_ptr< statement_hooks > > m_hooks;
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class statement_hooks_list;
+      };
+
+   public:
+      statement_hooks_list( const private_key /*unused*/, std::vector< std::shared_ptr< statement_hooks > >&& hooks )
+         : m_hooks( std::move( hooks ) )
+      {
+         m_hooks.erase( std::remove( m_hooks.begin(), m_hooks.end(), nullptr ), m_hooks.end() );
+      }
+
+      statement_hooks_list( const statement_hooks_list& ) = delete;
+      statement_hooks_list( statement_hooks_list&& ) = delete;
+      void operator=( const statement_hooks_list& ) = delete;
+      void operator=( statement_hooks_list&& ) = delete;
+
+      ~statement_hooks_list() override = default;
+
+      [[nodiscard]] static auto create( std::vector< std::shared_ptr< statement_hooks > > hooks ) -> std::shared_ptr< statement_hooks_list >
+      {
+         return std::make_shared< statement_hooks_list >( private_key(), std::move( hooks ) );
+      }
+
+      [[nodiscard]] auto hooks() const noexcept -> const std::vector< std::shared_ptr< statement_hooks > >&
+      {
+         return m_hooks;
+      }
+
+      void on_start( const statement_event& e ) override
+      {
+         for( const auto& h : m_hooks ) {
+            h->on_start( e );
+         }
+      }
+
+      void on_sent( const statement_event& e ) override
+      {
+         for( const auto& h : m_hooks ) {
+            h->on_sent( e );
+         }
+      }
+
+      void on_first_byte( const statement_event& e ) override
+      {
+         for( const auto& h : m_hooks ) {
+            h->on_first_byte( e );
+         }
+      }
+
+      void on_result( const statement_event& e ) override
+      {
+         for( const auto& h : m_hooks ) {
+            h->on_result( e );
+         }
+      }
+   };
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,120 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TAO_PQ_STATEMENT_STATISTICS_HPP
+#define TAO_PQ_STATEMENT_STATISTICS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <tao/pq/statement_hooks.hpp>
+
+namespace tao::pq
+{
+   // a log-linear histogram of latencies with a relative error of at most 1/32,
+   // similar to an HDR histogram with two significant decimal digits
+   class statement_histogram final
+   {
+   private:
+      std::vector< std::uint64_t > m_counts;
+      std::uint64_t m_count = 0;
+      std::chrono::microseconds m_min{};
+      std::chrono::microseconds m_max{};
+      std::chrono::microseconds m_sum{};
+
+   public:
+      void record( const std::chrono::microseconds value );
+
+      [[nodiscard]] auto count() const noexcept -> std::uint64_t
+      {
+         return m_count;
+      }
+
+      [[nodiscard]] auto min() const noexcept -> std::chrono::microseconds
+      {
+         return m_min;
+      }
+
+      [[nodiscard]] auto max() const noexcept -> std::chrono::microseconds
+      {
+         return m_max;
+      }
+
+      [[nodiscard]] auto sum() const noexcept -> std::chrono::microseconds
+      {
+         return m_sum;
+      }
+
+      [[nodiscard]] auto mean() const noexcept -> std::chrono::microseconds;
+
+      // the highest latency equivalent to the given percentile, in the range [0, 100]
+      [[nodiscard]] auto percentile( const double p ) const -> std::chrono::microseconds;
+   };
+
+   struct statement_record
+   {
+      std::string key;  // normalized statement or name of the prepared statement
+      bool prepared = false;
+      std::size_t calls = 0;
+      std::size_t errors = 0;
+      std::size_t rows = 0;
+      std::size_t bytes_sent = 0;
+      std::size_t bytes_received = 0;
+      statement_histogram latency;
+   };
+
+   // aggregates the statements executed on all connections it is installed on as hooks
+   class statement_statistics final
+      : public statement_hooks
+   {
+   private:
+      mutable std::mutex m_mutex;
+      std::unordered_map< std::string, statement_record > m_records;
+
+      // pass-key idiom
+      class private_key final
+      {
+         private_key() = default;
+         friend class statement_statistics;
+      };
+
+   public:
+      explicit statement_statistics( const private_key /*unused*/ ) noexcept {}
+
+      statement_statistics( const statement_statistics& ) = delete;
+      statement_statistics( statement_statistics&& ) = delete;
+      void operator=( const statement_statistics& ) = delete;
+      void operator=( statement_statistics&& ) = delete;
+
+      ~statement_statistics() override = default;
+
+      [[nodiscard]] static auto create() -> std::shared_ptr< statement_statistics >;
+
+      // replaces literals with '?' and collapses whitespace
+      [[nodiscard]] static auto normalize( const std::string_view statement ) -> std::string;
+
+      void on_result( const statement_event& e ) override;
+
+      // all records, the statements with the highest total latency first
+      [[nodiscard]] auto records() const -> std::vector< statement_record >;
+      [[nodiscard]] auto record( const std::string_view key ) const -> std::optional< statement_record >;
+
+      void reset() noexcept;
+
+      // a tab-separated table of all records with a header line
+      [[nodiscard]] auto dump() const -> std::string;
+      void dump( const std::string& filename ) const;
+   };
+
+}  // namespace tao::pq
+
+#endif
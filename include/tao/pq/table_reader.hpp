@@ -19,6 +19,8 @@
 
 #include <libpq-fe.h>
 
+#include <tao/pq/awaitable.hpp>
+#include <tao/pq/internal/async.hpp>
 #include <tao/pq/internal/zsv.hpp>
 #include <tao/pq/table_row.hpp>
 #include <tao/pq/transaction.hpp>
@@ -28,6 +30,8 @@ namespace tao::pq
    class table_reader final
    {
    protected:
+      friend class internal::table_row_operation;
+
       std::shared_ptr< transaction > m_previous;
       std::shared_ptr< transaction > m_transaction;
       std::size_t m_columns;
@@ -71,6 +75,9 @@ namespace tao::pq
          return parse_data();
       }
 
+      // asynchronous variant of get_row(), see <tao/pq/coroutine.hpp>
+      [[nodiscard]] auto get_row_async() -> awaitable< bool >;
+
       [[nodiscard]] auto has_data() const noexcept -> bool
       {
          return !m_data.empty();
@@ -12,6 +12,8 @@
 #include <type_traits>
 #include <utility>
 
+#include <tao/pq/awaitable.hpp>
+#include <tao/pq/internal/async.hpp>
 #include <tao/pq/internal/gen.hpp>
 #include <tao/pq/internal/zsv.hpp>
 #include <tao/pq/parameter_traits.hpp>
@@ -22,6 +24,9 @@ namespace tao::pq
    class table_writer final
    {
    protected:
+      friend class internal::table_flush_operation;
+      friend class internal::table_commit_operation;
+
       std::shared_ptr< transaction > m_previous;
       std::shared_ptr< transaction > m_transaction;
 
@@ -72,6 +77,10 @@ namespace tao::pq
       }
 
       auto commit() -> std::size_t;
+
+      // asynchronous variants, see <tao/pq/coroutine.hpp>
+      [[nodiscard]] auto flush_async() -> awaitable< void >;
+      [[nodiscard]] auto commit_async() -> awaitable< std::size_t >;
    };
 
 }  // namespace tao::pq
@@ -16,6 +16,7 @@
 
 #include <libpq-fe.h>
 
+#include <tao/pq/awaitable.hpp>
 #include <tao/pq/internal/gen.hpp>
 #include <tao/pq/internal/zsv.hpp>
 #include <tao/pq/oid.hpp>
@@ -24,6 +25,7 @@
 
 namespace tao::pq
 {
+   class cancel_handle;
    class connection;
    class table_reader;
    class table_writer;
@@ -65,7 +67,17 @@ namespace tao::pq
                         const int lengths[],
                         const int formats[] );
 
-      template< std::size_t... Os, std::size_t... Is, typename... Ts >
+      void defer_params( const char* statement,
+                         const int n_params,
+                         const Oid types[],
+                         const char* const values[],
+                         const int lengths[],
+                         const int formats[] );
+
+      void sync_deferred();
+      void check_asynchronous() const;
+
+      template< bool Deferred, std::size_t... Os, std::size_t... Is, typename... Ts >
       void send_indexed( const char* statement,
                          std::index_sequence< Os... > /*unused*/,
                          std::index_sequence< Is... > /*unused*/,
@@ -75,14 +87,19 @@ namespace tao::pq
          const char* const values[] = { std::get< Os >( tuple ).template value< Is >()... };
          const int lengths[] = { std::get< Os >( tuple ).template length< Is >()... };
          const int formats[] = { std::get< Os >( tuple ).template format< Is >()... };
-         send_params( statement, sizeof...( Os ), types, values, lengths, formats );
+         if constexpr( Deferred ) {
+            defer_params( statement, sizeof...( Os ), types, values, lengths, formats );
+         }
+         else {
+            send_params( statement, sizeof...( Os ), types, values, lengths, formats );
+         }
       }
 
-      template< typename... Ts >
+      template< bool Deferred, typename... Ts >
       void send_traits( const char* statement, const Ts&... ts )
       {
          using gen = internal::gen< Ts::columns... >;
-         transaction::send_indexed( statement, typename gen::outer_sequence(), typename gen::inner_sequence(), std::tie( ts... ) );
+         transaction::send_indexed< Deferred >( statement, typename gen::outer_sequence(), typename gen::inner_sequence(), std::tie( ts... ) );
       }
 
    public:
@@ -93,6 +110,8 @@ namespace tao::pq
 
       [[nodiscard]] auto subtransaction() -> std::shared_ptr< transaction >;
 
+      [[nodiscard]] auto cancel_handle() const -> std::shared_ptr< pq::cancel_handle >;
+
       template< typename... As >
       void send( const internal::zsv statement, As&&... as )
       {
@@ -101,7 +120,21 @@ namespace tao::pq
             send_params( statement, 0, nullptr, nullptr, nullptr, nullptr );
          }
          else {
-            send_traits( statement, parameter_traits< std::decay_t< As > >( std::forward< As >( as ) )... );
+            send_traits< false >( statement, parameter_traits< std::decay_t< As > >( std::forward< As >( as ) )... );
+         }
+      }
+
+      // queue a statement whose result is not needed, errors are reported
+      // by the next statement that retrieves a result or by commit()
+      template< typename... As >
+      void defer( const internal::zsv statement, As&&... as )
+      {
+         check_current_transaction();
+         if constexpr( sizeof...( As ) == 0 ) {
+            defer_params( statement, 0, nullptr, nullptr, nullptr, nullptr );
+         }
+         else {
+            send_traits< true >( statement, parameter_traits< std::decay_t< As > >( std::forward< As >( as ) )... );
          }
       }
 
@@ -115,6 +148,18 @@ namespace tao::pq
          return transaction::get_result( start );
       }
 
+      // asynchronous variants, see <tao/pq/coroutine.hpp>
+      [[nodiscard]] auto get_result_async( const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now() ) -> awaitable< result >;
+
+      template< typename... As >
+      [[nodiscard]] auto execute_async( const internal::zsv statement, As&&... as ) -> awaitable< result >
+      {
+         const auto start = std::chrono::steady_clock::now();
+         check_asynchronous();
+         transaction::send( statement, std::forward< As >( as )... );
+         return transaction::get_result_async( start );
+      }
+
       void commit();
       void rollback();
 
@@ -173,7 +218,10 @@ namespace tao::pq
       public:
          explicit transaction_guard( const std::shared_ptr< pq::connection >& connection )
             : subtransaction_base( connection )
-         {}
+         {
+            // COPY can not be pipelined with deferred statements
+            sync_deferred();
+         }
 
       private:
          // LCOV_EXCL_START
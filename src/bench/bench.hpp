@@ -0,0 +1,191 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SRC_BENCH_BENCH_HPP  // NOLINT(llvm-header-guard)
+#define SRC_BENCH_BENCH_HPP
+
+// This is an internal header used for benchmarks.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tao::pq::bench
+{
+   using clock = std::chrono::steady_clock;
+
+   // the minimum time spent measuring each benchmark
+   inline clock::duration duration = std::chrono::milliseconds( 200 );
+
+   // only benchmarks whose name contains the filter are run
+   inline std::string_view filter;
+
+   inline void init( const int argc, char** argv )
+   {
+      if( argc > 1 ) {
+         filter = argv[ 1 ];
+      }
+   }
+
+   [[nodiscard]] inline auto selected( const std::string_view name ) noexcept -> bool
+   {
+      return name.find( filter ) != std::string_view::npos;
+   }
+
+   // prevents the compiler from optimizing away the computation of a value
+   template< typename T >
+   void keep( const T& value ) noexcept
+   {
+#if defined( _MSC_VER )
+      static const void* volatile sink;
+      sink = &value;
+#else
+      __asm__ __volatile__( "" : : "r"( &value ) : "memory" );
+#endif
+   }
+
+   // prints the results as JSON lines, one object per benchmark
+   inline void report( const std::string_view name, const std::size_t operations, const clock::duration elapsed, const std::size_t bytes, const std::string& extra = std::string() )
+   {
+      const double seconds = std::chrono::duration< double >( elapsed ).count();
+      std::printf( "{\"benchmark\":\"%.*s\",\"operations\":%zu,\"seconds\":%.6f,\"ops_per_s\":%.1f,\"ns_per_op\":%.1f",
+                   static_cast< int >( name.size() ),
+                   name.data(),
+                   operations,
+                   seconds,
+                   static_cast< double >( operations ) / seconds,
+                   seconds * 1e9 / static_cast< double >( operations ) );
+      if( bytes != 0 ) {
+         std::printf( ",\"mb_per_s\":%.1f", static_cast< double >( bytes ) / seconds / 1e6 );
+      }
+      std::printf( "%s}\n", extra.c_str() );
+      std::fflush( stdout );
+   }
+
+   // runs f in batches of doubling size until the batch takes at least the configured duration,
+   // each call of f performs the given number of operations and processes the given amount of data
+   template< typename F >
+   void run( const std::string_view name, const std::size_t bytes, F f, const std::size_t operations = 1 )
+   {
+      if( !bench::selected( name ) ) {
+         return;
+      }
+      f();  // warm-up
+      for( std::size_t n = 1;; n *= 2 ) {
+         const auto start = clock::now();
+         for( std::size_t i = 0; i < n; ++i ) {
+            f();
+         }
+         const auto elapsed = clock::now() - start;
+         if( elapsed >= duration ) {
+            bench::report( name, n * operations, elapsed, n * bytes );
+            return;
+         }
+      }
+   }
+
+   // formats the latency percentiles in microseconds as additional fields of a report
+   [[nodiscard]] inline auto percentiles( std::vector< clock::duration >& samples ) -> std::string
+   {
+      std::sort( samples.begin(), samples.end() );
+      const auto at = [ & ]( const double p ) {
+         const auto index = std::min( samples.size() - 1, static_cast< std::size_t >( p * static_cast< double >( samples.size() ) ) );
+         return std::chrono::duration< double, std::micro >( samples[ index ] ).count();
+      };
+      char buffer[ 128 ];
+      std::snprintf( buffer, sizeof( buffer ), ",\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f", at( 0.5 ), at( 0.9 ), at( 0.99 ), at( 1.0 ) );
+      return buffer;
+   }
+
+   // runs f concurrently in the given number of threads for the configured duration and measures
+   // the latency of each call, each call of f performs the given number of operations and processes
+   // the given amount of data
+   template< typename F >
+   void measure( const std::string_view name, const std::size_t threads, const std::size_t bytes, F f, const std::size_t operations = 1 )
+   {
+      if( !bench::selected( name ) ) {
+         return;
+      }
+      std::atomic< std::size_t > ready( 0 );
+      std::atomic< bool > started( false );
+      std::atomic< bool > done( false );
+      std::mutex mutex;
+      std::exception_ptr error;
+      std::vector< std::vector< clock::duration > > samples( threads );
+      std::vector< std::thread > workers;
+      workers.reserve( threads );
+      for( std::size_t i = 0; i < threads; ++i ) {
+         workers.emplace_back( [ &, i ] {
+            bool warm = false;
+            try {
+               f();
+               warm = true;
+               ready.fetch_add( 1 );
+               while( !started.load() ) {
+                  std::this_thread::yield();
+               }
+               while( !done.load( std::memory_order_relaxed ) ) {
+                  const auto begin = clock::now();
+                  f();
+                  samples[ i ].push_back( clock::now() - begin );
+               }
+            }
+            catch( ... ) {
+               const std::lock_guard lock( mutex );
+               if( !error ) {
+                  error = std::current_exception();
+               }
+               done.store( true );
+               if( !warm ) {
+                  ready.fetch_add( 1 );
+               }
+            }
+         } );
+      }
+      while( ready.load() < threads ) {
+         std::this_thread::yield();
+      }
+      const auto start = clock::now();
+      started.store( true );
+      const auto end = start + duration;
+      while( !done.load() && ( clock::now() < end ) ) {
+         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+      }
+      done.store( true );
+      for( auto& worker : workers ) {
+         worker.join();
+      }
+      const auto elapsed = clock::now() - start;
+      if( error ) {
+         std::rethrow_exception( error );
+      }
+
+      std::vector< clock::duration > all;
+      for( const auto& s : samples ) {
+         all.insert( all.end(), s.begin(), s.end() );
+      }
+      if( all.empty() ) {
+         return;
+      }
+      bench::report( name, all.size() * operations, elapsed, all.size() * bytes, bench::percentiles( all ) );
+   }
+
+   template< typename F >
+   void measure( const std::string_view name, const std::size_t bytes, F f, const std::size_t operations = 1 )
+   {
+      bench::measure( name, 1, bytes, std::move( f ), operations );
+   }
+
+}  // namespace tao::pq::bench
+
+#endif
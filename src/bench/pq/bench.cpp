@@ -0,0 +1,153 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../../test/getenv.hpp"
+#include "../bench.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <ios>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <tao/pq.hpp>
+
+namespace
+{
+   namespace bench = tao::pq::bench;
+
+   // the rows used for bulk transfer have a fixed size in COPY text format
+   constexpr int first_key = 1000000;
+   const std::string payload( 100, 'x' );
+   constexpr std::size_t row_size = 7 + 1 + 100 + 1;
+
+   constexpr std::size_t rows_per_batch = 1000;
+   constexpr std::size_t rows_in_table = 10000;
+
+   constexpr std::size_t chunk_size = 1024 * 1024;
+
+   void insert( tao::pq::table_writer& tw, const std::size_t rows )
+   {
+      for( std::size_t i = 0; i < rows; ++i ) {
+         tw.insert( first_key + static_cast< int >( i % 1000000 ), payload );
+      }
+   }
+
+   void statements( const std::shared_ptr< tao::pq::connection >& connection )
+   {
+      bench::measure( "execute/direct", 0, [ & ] {
+         const auto result = connection->direct()->execute( "SELECT $1::INTEGER", 42 );
+         bench::keep( result );
+      } );
+
+      connection->prepare( "taopq_bench", "SELECT $1::INTEGER" );
+      bench::measure( "execute/prepared", 0, [ & ] {
+         const auto result = connection->direct()->execute( "taopq_bench", 42 );
+         bench::keep( result );
+      } );
+      connection->deallocate( "taopq_bench" );
+
+      bench::measure( "transaction/begin_commit", 0, [ & ] {
+         connection->transaction()->commit();
+      } );
+   }
+
+   void pool( const std::string& connection_info )
+   {
+      const auto pool = tao::pq::connection_pool::create( connection_info );
+      for( std::size_t threads = 1; threads <= 64; threads *= 2 ) {
+         bench::measure( "pool/checkout/" + std::to_string( threads ), threads, 0, [ & ] {
+            const auto connection = pool->connection();
+            bench::keep( connection );
+         } );
+      }
+   }
+
+   void bulk_transfer( const std::shared_ptr< tao::pq::connection >& connection )
+   {
+      connection->execute( "CREATE TEMPORARY TABLE taopq_bench ( a INTEGER NOT NULL, b TEXT NOT NULL )" );
+
+      // the rows are rolled back so the table does not grow while measuring
+      const auto write = [ & ] {
+         const auto tr = connection->transaction();
+         tao::pq::table_writer tw( tr, "COPY taopq_bench ( a, b ) FROM STDIN" );
+         insert( tw, rows_per_batch );
+         std::ignore = tw.commit();
+         tr->rollback();
+      };
+      bench::measure( "table_writer", rows_per_batch * row_size, write, rows_per_batch );
+
+      {
+         tao::pq::table_writer tw( connection->direct(), "COPY taopq_bench ( a, b ) FROM STDIN" );
+         insert( tw, rows_in_table );
+         std::ignore = tw.commit();
+      }
+      const auto read = [ & ] {
+         tao::pq::table_reader tr( connection->direct(), "COPY taopq_bench ( a, b ) TO STDOUT" );
+         std::size_t rows = 0;
+         while( tr.get_row() ) {
+            ++rows;
+         }
+         bench::keep( rows );
+      };
+      bench::measure( "table_reader", rows_in_table * row_size, read, rows_in_table );
+
+      connection->execute( "DROP TABLE taopq_bench" );
+   }
+
+   // the large object is created in a transaction which is rolled back, so it is removed afterwards
+   void large_object( const std::shared_ptr< tao::pq::connection >& connection )
+   {
+      std::vector< char > buffer( chunk_size, 'x' );
+      const auto tr = connection->transaction();
+      const auto id = tao::pq::large_object::create( tr );
+      tao::pq::large_object lo( tr, id, std::ios_base::in | std::ios_base::out );
+
+      bench::measure( "large_object/write", chunk_size, [ & ] {
+         lo.seek( 0, std::ios_base::beg );
+         lo.write( buffer.data(), buffer.size() );
+      } );
+
+      bench::measure( "large_object/read", chunk_size, [ & ] {
+         lo.seek( 0, std::ios_base::beg );
+         const auto size = lo.read( buffer.data(), buffer.size() );
+         bench::keep( size );
+      } );
+
+      lo.close();
+      tr->rollback();
+   }
+
+   void run()
+   {
+      const auto connection_info = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+      const auto connection = tao::pq::connection::create( connection_info );
+
+      bench::duration = std::chrono::seconds( 1 );
+      statements( connection );
+      pool( connection_info );
+      bulk_transfer( connection );
+      large_object( connection );
+   }
+
+}  // namespace
+
+auto main( int argc, char** argv ) -> int
+{
+   try {
+      bench::init( argc, argv );
+      run();
+   }
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      return 1;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      return 1;
+   }
+}
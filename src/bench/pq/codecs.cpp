@@ -0,0 +1,283 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../bench.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <libpq-fe.h>
+
+#include <tao/pq.hpp>
+#include <tao/pq/internal/result_factory.hpp>
+#include <tao/pq/internal/table_reader_parse.hpp>
+
+namespace example
+{
+   struct user
+   {
+      int id;
+      std::string name;
+      double score;
+      bool active;
+   };
+
+}  // namespace example
+
+template<>
+inline constexpr bool tao::pq::is_aggregate< example::user > = true;
+
+namespace
+{
+   namespace bench = tao::pq::bench;
+
+   // a result built without a server, all columns are of type TEXT
+   [[nodiscard]] auto synthetic_result( const std::size_t columns, const std::vector< std::vector< const char* > >& rows ) -> tao::pq::result
+   {
+      std::unique_ptr< PGresult, decltype( &PQclear ) > pgresult( PQmakeEmptyPGresult( nullptr, PGRES_TUPLES_OK ), &PQclear );
+      std::vector< std::string > names( columns );
+      std::vector< PGresAttDesc > attributes( columns );
+      for( std::size_t i = 0; i < columns; ++i ) {
+         names[ i ] = "c" + std::to_string( i );
+         attributes[ i ] = PGresAttDesc();
+         attributes[ i ].name = names[ i ].data();
+         attributes[ i ].typid = 25;
+         attributes[ i ].typlen = -1;
+         attributes[ i ].atttypmod = -1;
+      }
+      if( PQsetResultAttrs( pgresult.get(), static_cast< int >( columns ), attributes.data() ) == 0 ) {
+         throw std::runtime_error( "PQsetResultAttrs() failed" );
+      }
+      for( std::size_t r = 0; r < rows.size(); ++r ) {
+         for( std::size_t c = 0; c < columns; ++c ) {
+            const char* value = rows[ r ][ c ];
+            char* data = const_cast< char* >( value );  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+            const int length = ( value == nullptr ) ? -1 : static_cast< int >( std::strlen( value ) );
+            if( PQsetvalue( pgresult.get(), static_cast< int >( r ), static_cast< int >( c ), data, length ) == 0 ) {
+               throw std::runtime_error( "PQsetvalue() failed" );
+            }
+         }
+      }
+      return tao::pq::internal::result_factory::create( pgresult.release() );
+   }
+
+   // fills the parameter arrays the same way tao::pq::transaction does for a statement
+   template< typename T, std::size_t... Is >
+   void fill( const T& value, std::index_sequence< Is... > /*unused*/ )
+   {
+      const tao::pq::parameter_traits< T > traits( value );
+      const Oid types[] = { static_cast< Oid >( traits.template type< Is >() )... };
+      const char* const values[] = { traits.template value< Is >()... };
+      const int lengths[] = { traits.template length< Is >()... };
+      const int formats[] = { traits.template format< Is >()... };
+      bench::keep( types );
+      bench::keep( values );
+      bench::keep( lengths );
+      bench::keep( formats );
+   }
+
+   template< typename T >
+   void encode( const std::string_view name, const T& value )
+   {
+      bench::run( name, 0, [ & ] { fill( value, std::make_index_sequence< tao::pq::parameter_traits< T >::columns >() ); } );
+   }
+
+   // appends a row in COPY text format the same way tao::pq::table_writer::insert() does
+   template< typename T, std::size_t... Is >
+   void append_row( std::string& buffer, const T& value, std::index_sequence< Is... > /*unused*/ )
+   {
+      const tao::pq::parameter_traits< T > traits( value );
+      ( ( traits.template copy_to< Is >( buffer ), buffer += '\t' ), ... );
+      *buffer.rbegin() = '\n';
+   }
+
+   template< typename T >
+   void copy( const std::string_view name, const T& value )
+   {
+      std::string buffer;
+      append_row( buffer, value, std::make_index_sequence< tao::pq::parameter_traits< T >::columns >() );
+      const auto bytes = buffer.size();
+      bench::run( name, bytes, [ & ] {
+         buffer.clear();
+         append_row( buffer, value, std::make_index_sequence< tao::pq::parameter_traits< T >::columns >() );
+         bench::keep( buffer );
+      } );
+   }
+
+   template< typename T >
+   void decode( const std::string_view name, const char* value )
+   {
+      const auto bytes = std::strlen( value );
+      bench::run( name, bytes, [ & ] {
+         const auto result = tao::pq::result_traits< T >::from( value );
+         bench::keep( result );
+      } );
+   }
+
+   // decodes all rows of a result with tao::pq::row::as()
+   template< typename T >
+   void rows( const std::string_view name, const tao::pq::result& result )
+   {
+      const auto f = [ & ] {
+         for( const auto& row : result ) {
+            const auto value = row.as< T >();
+            bench::keep( value );
+         }
+      };
+      bench::run( name, 0, f, result.size() );
+   }
+
+   // decodes all rows of a result into a container with tao::pq::result::vector()
+   template< typename T >
+   void vector( const std::string_view name, const tao::pq::result& result )
+   {
+      const auto f = [ & ] {
+         const auto values = result.vector< T >();
+         bench::keep( values );
+      };
+      bench::run( name, 0, f, result.size() );
+   }
+
+   void parse( const std::string_view name, const std::string& row )
+   {
+      std::vector< char > buffer( row.size() + 1 );
+      std::vector< const char* > data;
+      bench::run( name, row.size(), [ & ] {
+         std::memcpy( buffer.data(), row.c_str(), row.size() + 1 );
+         const bool result = tao::pq::internal::table_reader_parse( buffer.data(), data );
+         bench::keep( result );
+         bench::keep( data );
+      } );
+   }
+
+   void append( const std::string_view name, const std::string_view value )
+   {
+      std::string buffer;
+      bench::run( name, value.size(), [ & ] {
+         buffer.clear();
+         tao::pq::internal::table_writer_append( buffer, value );
+         bench::keep( buffer );
+      } );
+   }
+
+   void run()
+   {
+      const std::string text( 32, 'x' );
+      const std::string long_text( 4096, 'x' );
+      const tao::pq::binary blob( 256, std::byte( 0xa5 ) );
+      const std::vector< int > ints = [] {
+         std::vector< int > result( 100 );
+         for( std::size_t i = 0; i < result.size(); ++i ) {
+            result[ i ] = static_cast< int >( i * 7919 );
+         }
+         return result;
+      }();
+      const std::vector< std::string > texts( 100, "a \"quoted\", escaped\\ text" );
+      const example::user user{ 42, "R. Giskard Reventlov", 3.14159, true };
+
+      encode( "encode/bool", true );
+      encode( "encode/char", 'x' );
+      encode( "encode/short", static_cast< short >( 12345 ) );
+      encode( "encode/int", 1234567 );
+      encode( "encode/unsigned", 1234567U );
+      encode( "encode/long_long", 1234567890123LL );
+      encode( "encode/float", 3.1415927F );
+      encode( "encode/double", 3.141592653589793 );
+      encode( "encode/const_char_ptr", text.c_str() );
+      encode( "encode/string", text );
+      encode( "encode/string_view", std::string_view( text ) );
+      encode( "encode/binary", blob );
+      encode( "encode/optional_int", std::optional< int >( 42 ) );
+      encode( "encode/optional_null", std::optional< int >() );
+      encode( "encode/tuple", std::make_tuple( 42, 3.14, text ) );
+      encode( "encode/aggregate", user );
+      encode( "encode/array_int", ints );
+      encode( "encode/array_string", texts );
+
+      copy( "copy/int", 1234567 );
+      copy( "copy/double", 3.141592653589793 );
+      copy( "copy/string", text );
+      copy( "copy/binary", blob );
+      copy( "copy/tuple", std::make_tuple( 42, 3.14, text ) );
+      copy( "copy/aggregate", user );
+      copy( "copy/array_int", ints );
+
+      decode< bool >( "decode/bool", "t" );
+      decode< char >( "decode/char", "x" );
+      decode< short >( "decode/short", "12345" );
+      decode< int >( "decode/int", "1234567" );
+      decode< unsigned >( "decode/unsigned", "1234567" );
+      decode< long long >( "decode/long_long", "1234567890123" );
+      decode< float >( "decode/float", "3.1415927" );
+      decode< double >( "decode/double", "3.141592653589793" );
+      decode< std::string_view >( "decode/string_view", text.c_str() );
+      decode< std::string >( "decode/string", text.c_str() );
+      decode< std::string >( "decode/long_string", long_text.c_str() );
+      {
+         std::string hex = "\\x";
+         for( int i = 0; i < 256; ++i ) {
+            hex += "a5";
+         }
+         decode< tao::pq::binary >( "decode/binary", hex.c_str() );
+      }
+      {
+         const tao::pq::parameter_traits< std::vector< int > > traits( ints );
+         decode< std::vector< int > >( "decode/array_int", traits.value< 0 >() );
+      }
+      {
+         const tao::pq::parameter_traits< std::vector< std::string > > traits( texts );
+         decode< std::vector< std::string > >( "decode/array_string", traits.value< 0 >() );
+      }
+
+      {
+         std::vector< std::string > values;
+         std::vector< std::vector< const char* > > data;
+         values.reserve( 1000 );
+         for( int i = 0; i < 1000; ++i ) {
+            values.push_back( std::to_string( i * 7919 ) );
+         }
+         for( const auto& v : values ) {
+            data.push_back( { v.c_str() } );
+         }
+         const auto result = synthetic_result( 1, data );
+         rows< int >( "rows/int", result );
+         rows< std::optional< int > >( "rows/optional_int", result );
+         vector< int >( "rows/vector_int", result );
+      }
+      {
+         std::vector< std::vector< const char* > > data( 1000, { "42", "R. Giskard Reventlov", "3.14159", "t" } );
+         const auto result = synthetic_result( 4, data );
+         rows< std::tuple< int, std::string, double, bool > >( "rows/tuple", result );
+         rows< example::user >( "rows/aggregate", result );
+      }
+      {
+         std::vector< std::vector< const char* > > data( 1000, { "42", nullptr } );
+         const auto result = synthetic_result( 2, data );
+         rows< std::pair< int, std::optional< std::string > > >( "rows/pair_null", result );
+      }
+
+      parse( "table_reader/plain", "42\tR. Giskard Reventlov\t3.14159\tt\n" );
+      parse( "table_reader/null", "42\t\\N\t\\N\tt\n" );
+      parse( "table_reader/escaped", "line\\none\\tand\\\\two\t" + text + "\\r\\n" + text + "\n" );
+      parse( "table_reader/long", long_text + '\t' + long_text + '\n' );
+
+      append( "table_writer/plain", long_text );
+      append( "table_writer/escaped", std::string( 1024, '\t' ) + std::string( 1024, '\\' ) + std::string( 1024, '\n' ) );
+   }
+
+}  // namespace
+
+auto main( int argc, char** argv ) -> int
+{
+   bench::init( argc, argv );
+   run();
+}
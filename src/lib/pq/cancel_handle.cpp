@@ -0,0 +1,322 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/cancel_handle.hpp>
+
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#if !defined( LIBPQ_HAS_ASYNC_CANCEL )
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <thread>
+#include <utility>
+#endif
+
+#include <tao/pq/exception.hpp>
+#include <tao/pq/internal/poll.hpp>
+#include <tao/pq/internal/unreachable.hpp>
+#include <tao/pq/internal/wakeup.hpp>
+
+namespace tao::pq
+{
+#if defined( LIBPQ_HAS_ASYNC_CANCEL )
+
+   cancel_handle::cancel_handle( const private_key /*unused*/, PGconn* pgconn )
+      : m_pgcancel( PQcancelCreate( pgconn ), &PQcancelFinish ),
+        m_async( PQcancelCreate( pgconn ), &PQcancelFinish ),
+        m_status( PGRES_POLLING_OK ),
+        m_started( false )
+   {
+      if( !m_pgcancel || !m_async ) {
+         throw std::bad_alloc();  // LCOV_EXCL_LINE
+      }
+   }
+
+   cancel_handle::~cancel_handle() = default;
+
+   void cancel_handle::send_cancel( const std::optional< std::chrono::steady_clock::time_point >& end )
+   {
+      const std::lock_guard lock( m_mutex );
+      PQcancelReset( m_pgcancel.get() );
+      if( PQcancelStart( m_pgcancel.get() ) == 0 ) {
+         throw std::runtime_error( std::string( "PQcancelStart() failed: " ) + PQcancelErrorMessage( m_pgcancel.get() ) );  // LCOV_EXCL_LINE
+      }
+      // as with PQconnectPoll(), start by waiting for the socket to become writable
+      auto status = PGRES_POLLING_WRITING;
+      while( true ) {
+         switch( status ) {
+            case PGRES_POLLING_OK:
+               return;
+
+            case PGRES_POLLING_READING:
+            case PGRES_POLLING_WRITING:
+               while( true ) {
+                  const auto ready = internal::poll( PQcancelSocket( m_pgcancel.get() ), status == PGRES_POLLING_WRITING, end ? internal::poll_timeout( *end ) : -1 );
+                  if( ready == internal::poll_status::timeout ) {
+                     throw timeout_reached( "timeout reached while sending cancel request" );
+                  }
+                  if( ready != internal::poll_status::again ) {
+                     break;
+                  }
+               }
+               break;
+
+               // LCOV_EXCL_START
+            case PGRES_POLLING_FAILED:
+               throw std::runtime_error( std::string( "PQcancelPoll() failed: " ) + PQcancelErrorMessage( m_pgcancel.get() ) );
+
+            default:
+               TAO_PQ_UNREACHABLE;
+               // LCOV_EXCL_STOP
+         }
+         status = PQcancelPoll( m_pgcancel.get() );
+      }
+   }
+
+   void cancel_handle::start()
+   {
+      PQcancelReset( m_async.get() );
+      m_started = false;
+      if( PQcancelStart( m_async.get() ) == 0 ) {
+         throw std::runtime_error( std::string( "PQcancelStart() failed: " ) + PQcancelErrorMessage( m_async.get() ) );  // LCOV_EXCL_LINE
+      }
+      m_status = PGRES_POLLING_WRITING;
+      m_started = true;
+   }
+
+   auto cancel_handle::poll() -> bool
+   {
+      if( !m_started ) {
+         throw std::logic_error( "invalid cancel request, not started" );
+      }
+      m_status = PQcancelPoll( m_async.get() );
+      switch( m_status ) {
+         case PGRES_POLLING_OK:
+            m_started = false;
+            return true;
+
+         case PGRES_POLLING_READING:
+         case PGRES_POLLING_WRITING:
+            return false;
+
+            // LCOV_EXCL_START
+         case PGRES_POLLING_FAILED:
+            m_started = false;
+            throw std::runtime_error( std::string( "PQcancelPoll() failed: " ) + PQcancelErrorMessage( m_async.get() ) );
+
+         default:
+            TAO_PQ_UNREACHABLE;
+            // LCOV_EXCL_STOP
+      }
+   }
+
+   auto cancel_handle::socket() const -> int
+   {
+      return PQcancelSocket( m_async.get() );
+   }
+
+   auto cancel_handle::wait_for_write() const noexcept -> bool
+   {
+      return m_status == PGRES_POLLING_WRITING;
+   }
+
+#else
+
+   namespace
+   {
+      // PQcancel() blocks until the request was sent, all such requests that must not block
+      // the caller are sent one after the other by a single thread, so a slow or unreachable
+      // server does not result in more and more threads; requests still queued at exit are dropped
+      class cancel_worker final
+      {
+      private:
+         std::mutex m_mutex;
+         std::condition_variable m_condition;
+         std::deque< std::function< void() > > m_queue;
+         bool m_stopping = false;
+         std::thread m_thread;
+
+         void run()
+         {
+            while( true ) {
+               std::function< void() > f;
+               {
+                  std::unique_lock lock( m_mutex );
+                  m_condition.wait( lock, [ this ] { return !m_queue.empty() || m_stopping; } );
+                  if( m_stopping ) {
+                     return;
+                  }
+                  f = std::move( m_queue.front() );
+                  m_queue.pop_front();
+               }
+               f();
+            }
+         }
+
+      public:
+         cancel_worker()
+            : m_thread( &cancel_worker::run, this )
+         {}
+
+         cancel_worker( const cancel_worker& ) = delete;
+         cancel_worker( cancel_worker&& ) = delete;
+         void operator=( const cancel_worker& ) = delete;
+         void operator=( cancel_worker&& ) = delete;
+
+         ~cancel_worker()
+         {
+            std::deque< std::function< void() > > dropped;
+            {
+               const std::lock_guard lock( m_mutex );
+               m_stopping = true;
+               dropped.swap( m_queue );
+            }
+            m_condition.notify_one();
+            m_thread.join();
+         }
+
+         void push( std::function< void() > f )
+         {
+            {
+               const std::lock_guard lock( m_mutex );
+               m_queue.emplace_back( std::move( f ) );
+            }
+            m_condition.notify_one();
+         }
+
+         [[nodiscard]] static auto instance() -> cancel_worker&
+         {
+            static cancel_worker worker;
+            return worker;
+         }
+      };
+
+      // PQcancel() itself is thread-safe
+      [[nodiscard]] auto send( PGcancel* pgcancel ) -> std::string
+      {
+         char buffer[ 256 ];
+         if( PQcancel( pgcancel, buffer, sizeof( buffer ) ) == 0 ) {
+            return buffer;  // LCOV_EXCL_LINE
+         }
+         return std::string();
+      }
+
+   }  // namespace
+
+   struct cancel_handle::request final
+   {
+      internal::wakeup wakeup;  // signalled when done
+      std::atomic< bool > done{ false };
+      std::string error;  // set before done
+   };
+
+   cancel_handle::cancel_handle( const private_key /*unused*/, PGconn* pgconn )
+      : m_pgcancel( PQgetCancel( pgconn ), &PQfreeCancel ),
+        m_started( false )
+   {
+      if( !m_pgcancel ) {
+         throw std::runtime_error( "PQgetCancel() failed" );  // LCOV_EXCL_LINE
+      }
+   }
+
+   cancel_handle::~cancel_handle() = default;
+
+   // the deadline only limits how long the caller waits, the worker might still send the request afterwards
+   void cancel_handle::send_cancel( const std::optional< std::chrono::steady_clock::time_point >& end )
+   {
+      if( !end ) {
+         const auto error = send( m_pgcancel.get() );
+         if( !error.empty() ) {
+            throw std::runtime_error( error );  // LCOV_EXCL_LINE
+         }
+         return;
+      }
+      const auto sent = std::make_shared< std::promise< void > >();
+      auto future = sent->get_future();
+      cancel_worker::instance().push( [ self = shared_from_this(), sent ] {
+         const auto error = send( self->m_pgcancel.get() );
+         if( error.empty() ) {
+            sent->set_value();
+         }
+         else {
+            sent->set_exception( std::make_exception_ptr( std::runtime_error( error ) ) );  // LCOV_EXCL_LINE
+         }
+      } );
+      if( future.wait_until( *end ) == std::future_status::timeout ) {
+         throw timeout_reached( "timeout reached while sending cancel request" );
+      }
+      future.get();
+   }
+
+   void cancel_handle::start()
+   {
+      auto r = std::make_shared< request >();
+      if( r->wakeup.socket() < 0 ) {
+         // without a pipe to signal completion, the request is sent right away
+         r->error = send( m_pgcancel.get() );
+         r->done = true;
+      }
+      else {
+         cancel_worker::instance().push( [ self = shared_from_this(), r ] {
+            r->error = send( self->m_pgcancel.get() );
+            r->done.store( true, std::memory_order_release );
+            r->wakeup.notify();
+         } );
+      }
+      m_request = std::move( r );
+      m_started = true;
+   }
+
+   auto cancel_handle::poll() -> bool
+   {
+      if( !m_started ) {
+         throw std::logic_error( "invalid cancel request, not started" );
+      }
+      if( !m_request->done.load( std::memory_order_acquire ) ) {
+         return false;
+      }
+      const auto r = std::move( m_request );
+      m_started = false;
+      if( !r->error.empty() ) {
+         throw std::runtime_error( r->error );  // LCOV_EXCL_LINE
+      }
+      return true;
+   }
+
+   auto cancel_handle::socket() const -> int
+   {
+      if( !m_request ) {
+         throw std::logic_error( "invalid cancel request, not started" );
+      }
+      return m_request->wakeup.socket();
+   }
+
+   auto cancel_handle::wait_for_write() const noexcept -> bool
+   {
+      return false;
+   }
+
+#endif
+
+   void cancel_handle::cancel()
+   {
+      send_cancel( std::nullopt );
+   }
+
+   void cancel_handle::cancel( const std::chrono::steady_clock::time_point end )
+   {
+      send_cancel( end );
+   }
+
+   void cancel_handle::cancel( const std::chrono::milliseconds timeout )
+   {
+      send_cancel( std::chrono::steady_clock::now() + timeout );
+   }
+
+}  // namespace tao::pq
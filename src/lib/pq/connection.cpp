@@ -4,20 +4,19 @@
 
 #include <tao/pq/connection.hpp>
 
+#include <algorithm>
 #include <cctype>
-#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 
-#if defined( _WIN32 )
-#include <winsock2.h>
-#else
-#include <poll.h>
-#endif
-
+#include <tao/pq/cancel_handle.hpp>
 #include <tao/pq/exception.hpp>
+#include <tao/pq/internal/poll.hpp>
 #include <tao/pq/internal/printf.hpp>
 #include <tao/pq/internal/unreachable.hpp>
 #include <tao/pq/notification.hpp>
@@ -26,37 +25,23 @@
 
 namespace tao::pq
 {
-   namespace internal
+   namespace
    {
-      // LCOV_EXCL_START
-      [[nodiscard, maybe_unused]] auto errno_result_to_string( const int e, char* buffer, int result ) -> std::string
+      [[nodiscard]] auto payload_size( const char* statement, const bool prepared, const int n_params, const char* const values[], const int lengths[], const int formats[] ) noexcept -> std::size_t
       {
-         if( result == 0 ) {
-            return buffer;
+         std::size_t result = prepared ? 0 : std::strlen( statement );
+         for( int i = 0; i < n_params; ++i ) {
+            if( values[ i ] != nullptr ) {
+               result += ( formats[ i ] != 0 ) ? static_cast< std::size_t >( lengths[ i ] ) : std::strlen( values[ i ] );
+            }
          }
-         return internal::printf( "unknown error code %d", e );
-      }
-
-      [[nodiscard, maybe_unused]] auto errno_result_to_string( const int /*unused*/, char* /*unused*/, char* result ) -> std::string
-      {
          return result;
       }
 
-      [[nodiscard]] auto errno_to_string( const int e ) -> std::string
-      {
-         char buffer[ 256 ];
-#if defined( _WIN32 )
-	#ifdef _MSC_VER
-		  return errno_result_to_string( e, buffer, strerror_s( buffer, e ) );
-	#else
-		  return errno_result_to_string( e, buffer, strerror_s(buffer, sizeof (buffer), e));
-	#endif
-#else
-         return errno_result_to_string( e, buffer, strerror_r( e, buffer, sizeof( buffer ) ) );
-#endif
-      }
-      // LCOV_EXCL_STOP
+   }  // namespace
 
+   namespace internal
+   {
       class transaction_base
          : public transaction
       {
@@ -105,7 +90,9 @@ namespace tao::pq
          }
 
          void v_commit() override
-         {}
+         {
+            sync_deferred();
+         }
 
          void v_rollback() override
          {}
@@ -145,10 +132,16 @@ namespace tao::pq
          : public transaction_base
       {
       public:
-         explicit top_level_transaction( const std::shared_ptr< pq::connection >& connection, const isolation_level il, const access_mode am )
+         explicit top_level_transaction( const std::shared_ptr< pq::connection >& connection, const isolation_level il, const access_mode am, const bool write_behind = false )
             : transaction_base( connection )
          {
-            this->execute( std::string( "START TRANSACTION" ) + isolation_level_extension( il ) + access_mode_extension( am ) );
+            const auto statement = std::string( "START TRANSACTION" ) + isolation_level_extension( il ) + access_mode_extension( am );
+            if( write_behind ) {
+               this->defer( statement );
+            }
+            else {
+               this->execute( statement );
+            }
          }
 
          ~top_level_transaction() override
@@ -181,7 +174,22 @@ namespace tao::pq
 
          void v_commit() override
          {
-            execute( "COMMIT TRANSACTION" );
+            try {
+               execute( "COMMIT TRANSACTION" );
+            }
+            catch( ... ) {
+               // a failed deferred statement aborts the pipeline, including the COMMIT
+               if( m_connection->attempt_rollback() ) {
+                  try {
+                     execute( "ROLLBACK TRANSACTION" );
+                  }
+                  // LCOV_EXCL_START
+                  catch( ... ) {
+                  }
+                  // LCOV_EXCL_STOP
+               }
+               throw;
+            }
          }
 
          void v_rollback() override
@@ -208,6 +216,9 @@ namespace tao::pq
 
    auto connection::attempt_rollback() const noexcept -> bool
    {
+      if( m_deferred != 0 ) {
+         return true;
+      }
       switch( transaction_status() ) {
          case transaction_status::idle:
          case transaction_status::active:
@@ -240,119 +251,303 @@ namespace tao::pq
                                  const int lengths[],
                                  const int formats[] )
    {
-      const auto result = is_prepared( statement ) ?
+      const bool prepared = is_prepared( statement );
+      const auto bytes = payload_size( statement, prepared, n_params, values, lengths, formats );
+      if( m_hooks ) {
+         connection::hook_start( statement, prepared, n_params, types, bytes );
+      }
+      const auto result = prepared ?
                              PQsendQueryPrepared( m_pgconn.get(), statement, n_params, values, lengths, formats, 0 ) :
                              PQsendQueryParams( m_pgconn.get(), statement, n_params, types, values, lengths, formats, 0 );
       if( result == 0 ) {
          throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
       }
+      ++m_io.statements;
+      connection::io_sent( bytes );
+      if( m_deferred != 0 ) {
+         // the statement joins the pending deferred statements in the same round trip
+         connection::pipeline_sync();
+      }
+      else if( m_result_limit ) {
+         // otherwise the limit is checked when the result is complete
+         std::ignore = PQsetSingleRowMode( m_pgconn.get() );
+      }
    }
 
-   auto connection::timeout_end( const std::chrono::steady_clock::time_point start ) const noexcept -> std::chrono::steady_clock::time_point
+   void connection::send_deferred( const char* statement,
+                                   const int n_params,
+                                   const Oid types[],
+                                   const char* const values[],
+                                   const int lengths[],
+                                   const int formats[] )
    {
-      return m_timeout ? ( start + *m_timeout ) : start;
+      if( m_sync_pending ) {
+         throw std::logic_error( "invalid deferred statement, pending result not retrieved" );
+      }
+      if( ( m_deferred == 0 ) && ( PQenterPipelineMode( m_pgconn.get() ) == 0 ) ) {
+         throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
+      }
+      const bool prepared = is_prepared( statement );
+      const auto result = prepared ?
+                             PQsendQueryPrepared( m_pgconn.get(), statement, n_params, values, lengths, formats, 0 ) :
+                             PQsendQueryParams( m_pgconn.get(), statement, n_params, types, values, lengths, formats, 0 );
+      if( result == 0 ) {
+         // LCOV_EXCL_START
+         if( m_deferred == 0 ) {
+            PQexitPipelineMode( m_pgconn.get() );
+         }
+         throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );
+         // LCOV_EXCL_STOP
+      }
+      ++m_io.statements;
+      connection::io_sent( payload_size( statement, prepared, n_params, values, lengths, formats ) );
+      ++m_deferred;
    }
 
-   void connection::wait( const bool wait_for_write, const std::chrono::steady_clock::time_point end )
+   void connection::connect( const std::chrono::steady_clock::time_point end )
    {
-      const short events = POLLIN | ( wait_for_write ? POLLOUT : 0 );
+      // as documented for PQconnectPoll(), start by waiting for the socket to become writable
+      auto status = PGRES_POLLING_WRITING;
       while( true ) {
-         int timeout = -1;
-         if( m_timeout ) {
-            timeout = static_cast< int >( std::chrono::duration_cast< std::chrono::milliseconds >( end - std::chrono::steady_clock::now() ).count() );
-            if( timeout < 0 ) {
-               timeout = 0;  // LCOV_EXCL_LINE
-            }
+         switch( status ) {
+            case PGRES_POLLING_OK:
+               return;
+
+            case PGRES_POLLING_READING:
+            case PGRES_POLLING_WRITING:
+               while( true ) {
+                  const auto ready = internal::poll( socket(), status == PGRES_POLLING_WRITING, internal::poll_timeout( end ) );
+                  if( ready == internal::poll_status::timeout ) {
+                     throw timeout_reached( "timeout reached while connecting" );
+                  }
+                  if( ready != internal::poll_status::again ) {
+                     break;
+                  }
+               }
+               break;
+
+            case PGRES_POLLING_FAILED:
+               throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );
+
+               // LCOV_EXCL_START
+            default:
+               TAO_PQ_UNREACHABLE;
+               // LCOV_EXCL_STOP
          }
+         status = PQconnectPoll( m_pgconn.get() );
+      }
+   }
+
+   void connection::hook_start( const char* statement, const bool prepared, const int n_params, const Oid types[], const std::size_t bytes )
+   {
+      statement_event event;
+      event.statement = statement;
+      event.prepared = prepared;
+      event.parameters = n_params;
+      event.types.reserve( static_cast< std::size_t >( n_params ) );
+      for( int i = 0; i < n_params; ++i ) {
+         event.types.push_back( static_cast< oid >( types[ i ] ) );
+      }
+      event.bytes_sent = bytes;
+      event.start = std::chrono::steady_clock::now();
+      m_event = std::move( event );
+      m_hooks->on_start( *m_event );
+   }
 
-#if defined( _WIN32 )
+   void connection::hook_sent()
+   {
+      if( m_event && ( m_event->sent == std::chrono::steady_clock::time_point() ) ) {
+         m_event->sent = std::chrono::steady_clock::now();
+         m_hooks->on_sent( *m_event );
+      }
+   }
 
-         WSAPOLLFD pfd = { static_cast< SOCKET >( socket() ), events, 0 };
-         const auto result = WSAPoll( &pfd, 1, timeout );
-         switch( result ) {
-            case 0:
-               m_pgconn.reset();
-               throw timeout_reached( "timeout reached" );
+   void connection::hook_first_byte()
+   {
+      // results of deferred statements sent before are received first
+      if( m_event && ( m_deferred == 0 ) && ( m_event->first_byte == std::chrono::steady_clock::time_point() ) ) {
+         connection::hook_sent();
+         m_event->first_byte = std::chrono::steady_clock::now();
+         m_hooks->on_first_byte( *m_event );
+      }
+   }
 
-            case 1:
-               if( ( pfd.revents & events ) == 0 ) {
-                  throw std::runtime_error( internal::printf( "WSAPoll() failed, events %hd, revents %hd", events, pfd.revents ) );
-               }
-               if( ( pfd.revents & POLLIN ) != 0 ) {
-                  get_notifications();
+   void connection::hook_result( const PGresult* result )
+   {
+      if( m_event ) {
+         connection::hook_first_byte();
+         auto event = std::move( *m_event );
+         m_event = std::nullopt;
+         event.done = std::chrono::steady_clock::now();
+         switch( ( result != nullptr ) ? PQresultStatus( result ) : PGRES_FATAL_ERROR ) {
+            case PGRES_TUPLES_OK: {
+               const int rows = PQntuples( result );
+               const int columns = PQnfields( result );
+               event.rows = static_cast< std::size_t >( rows );
+               for( int row = 0; row < rows; ++row ) {
+                  for( int column = 0; column < columns; ++column ) {
+                     event.bytes_received += static_cast< std::size_t >( PQgetlength( result, row, column ) );
+                  }
                }
-               return;
+               break;
+            }
 
-            case SOCKET_ERROR:
+            case PGRES_COMMAND_OK: {
+               const char* affected = PQcmdTuples( const_cast< PGresult* >( result ) );
+               event.rows = ( *affected == '\0' ) ? 0 : std::strtoull( affected, nullptr, 10 );
+               break;
+            }
+
+            case PGRES_EMPTY_QUERY:
+            case PGRES_COPY_IN:
+            case PGRES_COPY_OUT:
                break;
 
             default:
-               TAO_PQ_UNREACHABLE;
+               event.failed = true;
          }
+         m_hooks->on_result( event );
+      }
+   }
 
-         const int e = WSAGetLastError();
-         throw std::runtime_error( "WSAPoll() failed: " + internal::errno_to_string( e ) );
+   auto connection::timeout_end( const std::chrono::steady_clock::time_point start ) const noexcept -> std::chrono::steady_clock::time_point
+   {
+      if( m_deadline ) {
+         return m_timeout ? std::min( start + *m_timeout, m_deadline->end() ) : m_deadline->end();
+      }
+      return m_timeout ? ( start + *m_timeout ) : start;
+   }
 
-#else
+   auto connection::spin( const std::chrono::steady_clock::time_point end ) -> bool
+   {
+      const auto start = std::chrono::steady_clock::now();
+      const auto spin_end = has_timeout() ? std::min( start + m_spin, end ) : ( start + m_spin );
+      do {
+         if( PQconsumeInput( m_pgconn.get() ) == 0 ) {
+            throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
+         }
+         if( PQisBusy( m_pgconn.get() ) == 0 ) {
+            handle_notifications();
+            return true;
+         }
+      } while( std::chrono::steady_clock::now() < spin_end );
+      return false;
+   }
 
-         pollfd pfd = { socket(), events, 0 };
-         errno = 0;
-         const auto result = poll( &pfd, 1, timeout );
-         switch( result ) {
-            case 0:
-               m_pgconn.reset();
-               throw timeout_reached( "timeout reached" );
+   void connection::adapt_spin( const std::chrono::microseconds latency ) noexcept
+   {
+      // the spin budget adapts to the observed latency: it grows back to the configured maximum
+      // while results arrive within that maximum, even if they arrived only after spinning stopped,
+      // and it shrinks when spinning for the full maximum would have been futile
+      if( latency <= *m_busy_poll ) {
+         m_spin = std::min( m_spin * 2, *m_busy_poll );
+      }
+      else {
+         m_spin = std::max( m_spin / 2, std::chrono::microseconds( 1 ) );
+      }
+   }
 
-            case 1:
-               if( ( pfd.revents & events ) == 0 ) {
-                  throw std::runtime_error( internal::printf( "poll() failed, events %hd, revents %hd", events, pfd.revents ) );  // LCOV_EXCL_LINE
-               }
-               if( ( pfd.revents & POLLIN ) != 0 ) {
-                  get_notifications();
+   void connection::wait( const bool wait_for_write, const std::chrono::steady_clock::time_point end )
+   {
+      while( true ) {
+         const auto start = std::chrono::steady_clock::now();
+         const auto status = internal::poll( socket(), wait_for_write, has_timeout() ? internal::poll_timeout( end ) : -1 );
+         ++m_io.waits;
+         m_io.wait_time += std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - start );
+         switch( status ) {
+            case internal::poll_status::timeout:
+               connection::reset_after_timeout();
+               if( m_hooks ) {
+                  connection::hook_result( nullptr );
                }
+               throw timeout_reached( "timeout reached" );
+
+            case internal::poll_status::readable:
+               get_notifications();
                return;
 
-               // LCOV_EXCL_START
-            case -1:
-               break;
+            case internal::poll_status::writable:
+               return;
 
-            default:
-               TAO_PQ_UNREACHABLE;
+            case internal::poll_status::again:
+               break;  // LCOV_EXCL_LINE
          }
+      }
+   }
 
-         const int e = errno;
-         if( ( e != EINTR ) && ( e != EAGAIN ) ) {
-            throw std::runtime_error( "poll() failed: " + internal::errno_to_string( e ) );
+   void connection::cancel()
+   {
+      const auto handle = connection::cancel_handle();
+      if( has_timeout() ) {
+         handle->cancel( timeout_end() );
+      }
+      else {
+         handle->cancel();
+      }
+   }
+
+   void connection::clear_cancelled( const std::chrono::steady_clock::time_point end )
+   {
+      if( PQpipelineStatus( m_pgconn.get() ) != PQ_PIPELINE_OFF ) {
+         if( !m_sync_pending ) {
+            connection::pipeline_sync();
          }
-         // LCOV_EXCL_STOP
+         connection::clear_pipeline( end );
+         return;
+      }
+      while( const auto result = connection::get_next_result( end ) ) {
+         switch( PQresultStatus( result.get() ) ) {
+            case PGRES_COPY_IN:
+               connection::put_copy_end( "statement cancelled", end );
+               break;
+
+            case PGRES_COPY_OUT:
+               connection::clear_copy_data( end );
+               break;
 
-#endif
+            default:;
+         }
       }
    }
 
-   void connection::cancel()
+   void connection::reset_after_timeout() noexcept
    {
-      const std::unique_ptr< PGcancel, decltype( &PQfreeCancel ) > p( PQgetCancel( m_pgconn.get() ), &PQfreeCancel );
-      if( p ) {
-         char buffer[ 256 ];
-         if( PQcancel( p.get(), buffer, sizeof( buffer ) ) == 0 ) {
-            throw std::runtime_error( buffer );  // LCOV_EXCL_LINE
+      if( m_cancel_on_timeout && !m_cancelling ) {
+         // keep the connection if the server aborts the statement within the grace period,
+         // a timeout while cancelling ends up here again and resets the connection instead
+         m_cancelling = true;
+         try {
+            const auto end = std::chrono::steady_clock::now() + *m_cancel_on_timeout;
+            connection::cancel_handle()->cancel( end );
+            connection::clear_cancelled( end );
+            m_cancelling = false;
+            if( is_open() ) {
+               return;
+            }
+         }
+         catch( ... ) {
+            m_cancelling = false;
          }
       }
+      m_pgconn.reset();
    }
 
-   auto connection::get_result( const std::chrono::steady_clock::time_point end ) -> std::unique_ptr< PGresult, decltype( &PQclear ) >
+   auto connection::get_next_result( const std::chrono::steady_clock::time_point end ) -> std::unique_ptr< PGresult, decltype( &PQclear ) >
    {
       bool wait_for_write = true;
+      bool try_spin = m_busy_poll.has_value();
+      std::optional< std::chrono::steady_clock::time_point > spin_start;
       while( PQisBusy( m_pgconn.get() ) != 0 ) {
          if( wait_for_write ) {
             switch( PQflush( m_pgconn.get() ) ) {
                case 0:
                   wait_for_write = false;
+                  connection::hook_sent();
                   break;
 
                   // LCOV_EXCL_START
                case 1:
+                  ++m_io.flush_retries;
                   break;
 
                default:
@@ -360,10 +555,42 @@ namespace tao::pq
                   // LCOV_EXCL_STOP
             }
          }
+         if( try_spin && !wait_for_write ) {
+            try_spin = false;
+            spin_start = std::chrono::steady_clock::now();
+            if( connection::spin( end ) ) {
+               connection::hook_first_byte();
+               continue;
+            }
+         }
          connection::wait( wait_for_write, end );
+         if( !wait_for_write ) {
+            connection::hook_first_byte();
+         }
+      }
+      if( spin_start && m_busy_poll ) {
+         connection::adapt_spin( std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - *spin_start ) );
       }
 
       std::unique_ptr< PGresult, decltype( &PQclear ) > result( PQgetResult( m_pgconn.get() ), &PQclear );
+      if( result ) {
+         connection::io_received( PQresultMemorySize( result.get() ) );
+      }
+      return result;
+   }
+
+   auto connection::get_result( const std::chrono::steady_clock::time_point end ) -> std::unique_ptr< PGresult, decltype( &PQclear ) >
+   {
+      if( m_deferred != 0 ) {
+         if( !m_sync_pending ) {
+            connection::pipeline_sync();  // LCOV_EXCL_LINE
+         }
+         connection::check_deferred_results( end );
+      }
+      auto result = connection::get_next_result( end );
+      if( !result && m_sync_pending ) {
+         connection::clear_pipeline( end );
+      }
       handle_notifications();
       return result;
    }
@@ -373,6 +600,8 @@ namespace tao::pq
       while( true ) {
          const auto result = PQgetCopyData( m_pgconn.get(), &buffer, 1 );
          if( result > 0 ) {
+            connection::io_received( static_cast< std::size_t >( result ) );
+            connection::hook_copy_data( 0, static_cast< std::size_t >( result ) );
             return static_cast< std::size_t >( result );
          }
          switch( result ) {
@@ -405,10 +634,13 @@ namespace tao::pq
       while( true ) {
          switch( PQputCopyData( m_pgconn.get(), buffer, static_cast< int >( size ) ) ) {
             case 1:
+               connection::io_sent( size );
+               connection::hook_copy_data( size, 0 );
                return;
 
                // LCOV_EXCL_START
             case 0:
+               ++m_io.flush_retries;
                connection::wait( true, end );
                break;
 
@@ -422,16 +654,17 @@ namespace tao::pq
       }
    }
 
-   void connection::put_copy_end( const char* error_message )
+   void connection::put_copy_end( const char* error_message, const std::chrono::steady_clock::time_point end )
    {
-      const auto end = timeout_end();
       while( true ) {
          switch( PQputCopyEnd( m_pgconn.get(), error_message ) ) {
             case 1:
+               m_io_sent = true;
                return;
 
                // LCOV_EXCL_START
             case 0:
+               ++m_io.flush_retries;
                connection::wait( true, end );
                break;
 
@@ -445,6 +678,81 @@ namespace tao::pq
       }
    }
 
+   void connection::put_copy_end( const char* error_message )
+   {
+      connection::put_copy_end( error_message, timeout_end() );
+   }
+
+   // in single-row mode, the rows arrive as separate results and are collected into one,
+   // returns the size of the collected rows if they exceed the result limit, they are then discarded
+   auto connection::collect_rows( std::unique_ptr< PGresult, decltype( &PQclear ) >& result, std::unique_ptr< PGresult, decltype( &PQclear ) > next ) -> std::optional< std::size_t >
+   {
+      if( PQresultStatus( next.get() ) != PGRES_SINGLE_TUPLE ) {
+         // the final result of single-row mode has no rows
+         if( !result || ( PQresultStatus( result.get() ) != PGRES_TUPLES_OK ) || ( PQresultStatus( next.get() ) != PGRES_TUPLES_OK ) ) {
+            result = std::move( next );
+         }
+         return std::nullopt;
+      }
+      if( !result || ( PQresultStatus( result.get() ) != PGRES_TUPLES_OK ) ) {
+         result.reset( PQcopyResult( next.get(), PG_COPYRES_ATTRS | PG_COPYRES_TUPLES ) );
+         if( !result ) {
+            throw std::bad_alloc();  // LCOV_EXCL_LINE
+         }
+      }
+      else {
+         const int row = PQntuples( result.get() );
+         const int columns = PQnfields( next.get() );
+         for( int column = 0; column < columns; ++column ) {
+            const bool is_null = PQgetisnull( next.get(), 0, column ) != 0;
+            if( PQsetvalue( result.get(), row, column, is_null ? nullptr : PQgetvalue( next.get(), 0, column ), is_null ? -1 : PQgetlength( next.get(), 0, column ) ) == 0 ) {
+               throw std::bad_alloc();  // LCOV_EXCL_LINE
+            }
+         }
+      }
+      if( m_result_limit ) {
+         const std::size_t size = PQresultMemorySize( result.get() );
+         if( size > *m_result_limit ) {
+            result.reset();
+            return size;
+         }
+      }
+      return std::nullopt;
+   }
+
+   // the statement is cancelled as soon as the collected rows exceed the result limit
+   void connection::collect_result( std::unique_ptr< PGresult, decltype( &PQclear ) >& result, std::unique_ptr< PGresult, decltype( &PQclear ) > next, const std::chrono::steady_clock::time_point end )
+   {
+      if( const auto size = connection::collect_rows( result, std::move( next ) ) ) {
+         connection::cancel();
+         connection::clear_cancelled( end );
+         connection::exceed_result_limit( *size );
+      }
+   }
+
+   void connection::check_result_limit( const PGresult* result )
+   {
+      if( m_result_limit && ( result != nullptr ) ) {
+         const std::size_t size = PQresultMemorySize( result );
+         if( size > *m_result_limit ) {
+            connection::exceed_result_limit( size );
+         }
+      }
+   }
+
+   auto connection::result_limit_message( const std::size_t size ) const -> std::string
+   {
+      return internal::printf( "result of %zu bytes exceeds the limit of %zu bytes", size, *m_result_limit );
+   }
+
+   void connection::exceed_result_limit( const std::size_t size )
+   {
+      if( m_hooks ) {
+         connection::hook_result( nullptr );
+      }
+      throw pq::result_limit_exceeded( connection::result_limit_message( size ) );
+   }
+
    void connection::clear_results( const std::chrono::steady_clock::time_point end )
    {
       while( connection::get_result( end ) ) {
@@ -459,10 +767,106 @@ namespace tao::pq
       }
    }
 
-   connection::connection( const private_key /*unused*/, const std::string& connection_info )
-      : m_pgconn( PQconnectdb( connection_info.c_str() ), &PQfinish ),
-        m_current_transaction( nullptr )
+   void connection::pipeline_sync()
+   {
+      if( PQpipelineSync( m_pgconn.get() ) == 0 ) {
+         throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
+      }
+      m_sync_pending = true;
+   }
+
+   void connection::leave_pipeline()
+   {
+      m_deferred = 0;
+      m_sync_pending = false;
+      if( PQexitPipelineMode( m_pgconn.get() ) == 0 ) {
+         throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
+      }
+   }
+
+   void connection::clear_pipeline( const std::chrono::steady_clock::time_point end )
+   {
+      while( true ) {
+         const auto result = connection::get_next_result( end );
+         if( result ) {
+            if( PQresultStatus( result.get() ) == PGRES_PIPELINE_SYNC ) {
+               break;
+            }
+         }
+         else if( !is_open() ) {
+            throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
+         }
+      }
+      connection::leave_pipeline();
+   }
+
+   void connection::check_deferred_results( const std::chrono::steady_clock::time_point end )
    {
+      std::unique_ptr< PGresult, decltype( &PQclear ) > error( nullptr, &PQclear );
+      while( m_deferred != 0 ) {
+         auto result = connection::get_next_result( end );
+         if( !result ) {
+            if( !is_open() ) {
+               throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
+            }
+            --m_deferred;
+         }
+         else if( !error ) {
+            switch( PQresultStatus( result.get() ) ) {
+               case PGRES_COMMAND_OK:
+               case PGRES_TUPLES_OK:
+               case PGRES_EMPTY_QUERY:
+                  break;
+
+               default:
+                  error = std::move( result );
+            }
+         }
+      }
+      if( error ) {
+         // all following statements up to the next sync point were skipped by the server
+         connection::clear_pipeline( end );
+         internal::throw_sqlstate( error.get() );
+      }
+   }
+
+   void connection::sync_deferred( const std::chrono::steady_clock::time_point end )
+   {
+      if( m_deferred != 0 ) {
+         if( !m_sync_pending ) {
+            connection::pipeline_sync();
+         }
+         connection::check_deferred_results( end );
+         connection::clear_pipeline( end );
+      }
+   }
+
+   void connection::discard_deferred( const std::chrono::steady_clock::time_point end )
+   {
+      try {
+         connection::sync_deferred( end );
+      }
+      catch( ... ) {
+         // only errors reported by the deferred statements themselves are discarded
+         if( m_deferred != 0 ) {
+            throw;  // LCOV_EXCL_LINE
+         }
+      }
+   }
+
+   connection::connection( const private_key /*unused*/, const std::string& connection_info, const std::optional< pq::deadline >& dl )
+      : m_pgconn( dl ? PQconnectStart( connection_info.c_str() ) : PQconnectdb( connection_info.c_str() ), &PQfinish ),
+        m_current_transaction( nullptr ),
+        m_spin( 0 ),
+        m_cancelling( false ),
+        m_deferred( 0 ),
+        m_sync_pending( false ),
+        m_io_sent( false ),
+        m_result_memory( std::make_shared< internal::gauge >() )
+   {
+      if( dl && ( status() != connection_status::bad ) ) {
+         connection::connect( dl->end() );
+      }
       if( !is_open() ) {
          // note that we can not access the sqlstate after PQconnectdb(),
          // see https://stackoverflow.com/q/23349086/2073257
@@ -479,6 +883,13 @@ namespace tao::pq
       return std::make_shared< connection >( private_key(), connection_info );
    }
 
+   auto connection::create( const std::string& connection_info, const pq::deadline& dl ) -> std::shared_ptr< connection >
+   {
+      auto result = std::make_shared< connection >( private_key(), connection_info, dl );
+      result->set_deadline( dl );
+      return result;
+   }
+
    auto connection::error_message() const -> std::string
    {
       return PQerrorMessage( m_pgconn.get() );
@@ -548,13 +959,31 @@ namespace tao::pq
       return std::make_shared< internal::top_level_transaction >( shared_from_this(), il, am );
    }
 
+   auto connection::write_behind_transaction() -> std::shared_ptr< pq::transaction >
+   {
+      return std::make_shared< internal::top_level_transaction >( shared_from_this(), isolation_level::default_isolation_level, access_mode::default_access_mode, true );
+   }
+
+   auto connection::write_behind_transaction( const access_mode am, const isolation_level il ) -> std::shared_ptr< pq::transaction >
+   {
+      return std::make_shared< internal::top_level_transaction >( shared_from_this(), il, am, true );
+   }
+
+   auto connection::write_behind_transaction( const isolation_level il, const access_mode am ) -> std::shared_ptr< pq::transaction >
+   {
+      return std::make_shared< internal::top_level_transaction >( shared_from_this(), il, am, true );
+   }
+
    void connection::prepare( const std::string& name, const std::string& statement )
    {
       connection::check_prepared_name( name );
       const auto end = timeout_end();
+      connection::sync_deferred( end );
       if( PQsendPrepare( m_pgconn.get(), name.c_str(), statement.c_str(), 0, nullptr ) == 0 ) {
          throw pq::connection_error( PQerrorMessage( m_pgconn.get() ) );  // LCOV_EXCL_LINE
       }
+      ++m_io.statements;
+      connection::io_sent( name.size() + statement.size() );
       auto result = connection::get_result( end );
       switch( PQresultStatus( result.get() ) ) {
          case PGRES_COMMAND_OK:
@@ -632,6 +1061,14 @@ namespace tao::pq
       handle_notifications();
    }
 
+   auto connection::cancel_handle() -> std::shared_ptr< pq::cancel_handle >
+   {
+      if( !m_cancel_handle ) {
+         m_cancel_handle = std::make_shared< pq::cancel_handle >( pq::cancel_handle::private_key(), m_pgconn.get() );
+      }
+      return m_cancel_handle;
+   }
+
    auto connection::socket() const -> int
    {
       const auto fd = PQsocket( m_pgconn.get() );
@@ -651,4 +1088,76 @@ namespace tao::pq
       m_timeout = std::nullopt;
    }
 
+   void connection::set_cancel_on_timeout( const std::chrono::milliseconds grace_period )
+   {
+      m_cancel_on_timeout = grace_period;
+   }
+
+   void connection::reset_cancel_on_timeout() noexcept
+   {
+      m_cancel_on_timeout = std::nullopt;
+   }
+
+   void connection::set_busy_poll( const std::chrono::microseconds spin_budget )
+   {
+      if( m_busy_poll != spin_budget ) {
+         internal::set_busy_poll( socket(), spin_budget );
+         m_busy_poll = spin_budget;
+      }
+      m_spin = spin_budget;
+   }
+
+   void connection::reset_busy_poll() noexcept
+   {
+      if( m_busy_poll ) {
+         internal::set_busy_poll( PQsocket( m_pgconn.get() ), std::chrono::microseconds( 0 ) );
+         m_busy_poll = std::nullopt;
+      }
+   }
+
+   void connection::set_scheduler( const std::shared_ptr< pq::scheduler >& scheduler ) noexcept
+   {
+      m_scheduler = scheduler;
+   }
+
+   void connection::reset_scheduler() noexcept
+   {
+      m_scheduler.reset();
+   }
+
+   void connection::set_hooks( const std::shared_ptr< statement_hooks >& hooks ) noexcept
+   {
+      m_hooks = hooks;
+      m_event = std::nullopt;
+   }
+
+   void connection::reset_hooks() noexcept
+   {
+      m_hooks.reset();
+      m_event = std::nullopt;
+   }
+
+   void connection::set_result_limit( const std::size_t bytes )
+   {
+      if( bytes == 0 ) {
+         throw std::invalid_argument( "invalid result limit" );
+      }
+      m_result_limit = bytes;
+   }
+
+   void connection::reset_result_limit() noexcept
+   {
+      m_result_limit = std::nullopt;
+   }
+
+   void connection::set_deadline( const pq::deadline& dl )
+   {
+      m_deadline = dl;
+   }
+
+   void connection::reset_deadline() noexcept
+   {
+      m_deadline = std::nullopt;
+   }
+
 }  // namespace tao::pq
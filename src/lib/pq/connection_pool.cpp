@@ -4,15 +4,50 @@
 
 #include <tao/pq/connection_pool.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <tao/pq/exception.hpp>
+#include <tao/pq/parameter_traits_array.hpp>
+
 namespace tao::pq
 {
+   namespace
+   {
+      [[nodiscard]] auto session_key( const session_settings& settings ) -> std::string
+      {
+         std::string result;
+         for( const auto& [ name, value ] : settings ) {
+            result += name;
+            result += '\0';
+            result += value;
+            result += '\0';
+         }
+         return result;
+      }
+
+   }  // namespace
+
+   // all connections of the pool are created here, so the pool's accounting covers each of them
+   auto connection_pool::create_connection( const std::optional< pq::deadline >& dl ) const -> std::unique_ptr< pq::connection >
+   {
+      auto result = std::make_unique< pq::connection >( pq::connection::private_key(), m_connection_info, dl );
+      result->m_result_memory = std::make_shared< internal::gauge >( m_result_memory );
+      result->m_session_settings = session_key( {} );  // a new connection has no settings applied
+      return result;
+   }
+
    auto connection_pool::v_create() const -> std::unique_ptr< pq::connection >
    {
-      return std::make_unique< pq::connection >( pq::connection::private_key(), m_connection_info );
+      return connection_pool::create_connection( std::nullopt );
    }
 
    connection_pool::connection_pool( const private_key /*unused*/, const std::string_view connection_info )
-      : m_connection_info( connection_info )
+      : m_connection_info( connection_info ),
+        m_result_memory( std::make_shared< internal::gauge >() ),
+        m_session_hits( 0 ),
+        m_session_migrations( 0 )
    {}
 
    auto connection_pool::create( const std::string_view connection_info ) -> std::shared_ptr< connection_pool >
@@ -30,16 +65,235 @@ namespace tao::pq
       m_timeout = std::nullopt;
    }
 
-   auto connection_pool::connection() -> std::shared_ptr< pq::connection >
+   void connection_pool::set_cancel_on_timeout( const std::chrono::milliseconds grace_period )
+   {
+      m_cancel_on_timeout = grace_period;
+   }
+
+   void connection_pool::reset_cancel_on_timeout() noexcept
+   {
+      m_cancel_on_timeout = std::nullopt;
+   }
+
+   void connection_pool::set_busy_poll( const std::chrono::microseconds spin_budget )
+   {
+      m_busy_poll = spin_budget;
+   }
+
+   void connection_pool::reset_busy_poll() noexcept
+   {
+      m_busy_poll = std::nullopt;
+   }
+
+   void connection_pool::set_hooks( const std::shared_ptr< statement_hooks >& hooks ) noexcept
+   {
+      m_hooks = hooks;
+   }
+
+   void connection_pool::reset_hooks() noexcept
+   {
+      m_hooks.reset();
+   }
+
+   void connection_pool::set_result_limit( const std::size_t bytes )
+   {
+      if( bytes == 0 ) {
+         throw std::invalid_argument( "invalid result limit" );
+      }
+      m_result_limit = bytes;
+   }
+
+   void connection_pool::reset_result_limit() noexcept
+   {
+      m_result_limit = std::nullopt;
+   }
+
+   void connection_pool::configure( pq::connection& c ) const
    {
-      auto result = get();
       if( m_timeout ) {
-         result->set_timeout( *m_timeout );
+         c.set_timeout( *m_timeout );
       }
       else {
-         result->reset_timeout();
+         c.reset_timeout();
+      }
+      if( m_cancel_on_timeout ) {
+         c.set_cancel_on_timeout( *m_cancel_on_timeout );
+      }
+      else {
+         c.reset_cancel_on_timeout();
+      }
+      if( m_busy_poll ) {
+         c.set_busy_poll( *m_busy_poll );
+      }
+      else {
+         c.reset_busy_poll();
+      }
+      if( m_hooks != c.m_hooks ) {
+         c.set_hooks( m_hooks );
+      }
+      c.m_result_limit = m_result_limit;
+      c.reset_deadline();
+   }
+
+   void connection_pool::set_admission( const std::size_t max_connections, const std::vector< admission_class >& classes, const admission_policy policy )
+   {
+      std::atomic_store( &m_admission, std::make_shared< internal::admission >( max_connections, classes, policy ) );
+   }
+
+   void connection_pool::reset_admission() noexcept
+   {
+      std::atomic_store( &m_admission, std::shared_ptr< internal::admission >() );
+   }
+
+   auto connection_pool::admission_statistics() const -> std::vector< pq::admission_statistics >
+   {
+      if( const auto a = std::atomic_load( &m_admission ) ) {
+         return a->statistics();
+      }
+      return {};
+   }
+
+   void connection_pool::set_adaptive_sizing( const std::size_t min_connections, const std::size_t max_connections )
+   {
+      auto a = std::atomic_load( &m_admission );
+      if( !a ) {
+         // start small, the limit grows while requests have to wait
+         auto created = std::make_shared< internal::admission >( std::max< std::size_t >( min_connections, 1 ), std::vector< admission_class >{ { "default" } }, admission_policy::weighted_fair );
+         if( std::atomic_compare_exchange_strong( &m_admission, &a, created ) ) {
+            a = std::move( created );
+         }
+      }
+      a->set_sizing( min_connections, max_connections );
+   }
+
+   void connection_pool::reset_adaptive_sizing() noexcept
+   {
+      if( const auto a = std::atomic_load( &m_admission ) ) {
+         a->reset_sizing();
+      }
+   }
+
+   auto connection_pool::sizing_statistics() const -> std::optional< pq::sizing_statistics >
+   {
+      if( const auto a = std::atomic_load( &m_admission ) ) {
+         return a->sizing();
+      }
+      return std::nullopt;
+   }
+
+   auto connection_pool::admit( const std::size_t admission_class, const std::optional< std::chrono::steady_clock::time_point >& end ) -> std::shared_ptr< void >
+   {
+      // the admission may be replaced or reset by other threads, the lease keeps the one it was taken from alive
+      if( const auto a = std::atomic_load( &m_admission ) ) {
+         auto lease = a->acquire( admission_class, end );
+         if( const auto s = a->sizing() ) {
+            trim( s->limit );
+         }
+         return lease;
+      }
+      return nullptr;
+   }
+
+   auto connection_pool::connection() -> std::shared_ptr< pq::connection >
+   {
+      return connection_pool::connection( 0 );
+   }
+
+   auto connection_pool::connection( const pq::deadline& dl ) -> std::shared_ptr< pq::connection >
+   {
+      return connection_pool::connection( 0, dl );
+   }
+
+   void connection_pool::apply( pq::connection& c, const std::string& key, const session_settings& settings )
+   {
+      if( c.m_session_settings == key ) {
+         if( !key.empty() ) {
+            m_session_hits.fetch_add( 1, std::memory_order_relaxed );
+         }
+         return;
+      }
+      m_session_migrations.fetch_add( 1, std::memory_order_relaxed );
+
+      // the settings are unknown until they were applied successfully
+      const bool reset = !c.m_session_settings || !c.m_session_settings->empty();
+      c.m_session_settings = std::nullopt;
+      if( reset ) {
+         c.execute( "RESET ALL" );
+      }
+      if( !settings.empty() ) {
+         std::vector< std::string > names;
+         std::vector< std::string > values;
+         for( const auto& [ name, value ] : settings ) {
+            names.emplace_back( name );
+            values.emplace_back( value );
+         }
+         c.execute( "SELECT set_config( n, v, false ) FROM unnest( $1::TEXT[], $2::TEXT[] ) AS s( n, v )", names, values );
+      }
+      c.m_session_settings = key;
+   }
+
+   auto connection_pool::checkout( const std::size_t admission_class, const std::optional< pq::deadline >& dl, const session_settings& settings ) -> std::shared_ptr< pq::connection >
+   {
+      if( dl && dl->expired() ) {
+         throw timeout_reached( "deadline reached before borrowing a connection" );
+      }
+      const auto start = std::chrono::steady_clock::now();
+      auto lease = connection_pool::admit( admission_class, dl ? std::optional( dl->end() ) : std::nullopt );
+
+      // prefer a connection with the same settings, otherwise migrate the least recently used one
+      const auto key = session_key( settings );
+      auto result = try_get_if( [ & ]( const pq::connection& c ) { return c.m_session_settings == key; } );
+      if( !result ) {
+         result = try_get_oldest();
+      }
+      if( !result ) {
+         result = adopt( connection_pool::create_connection( dl ) );
+      }
+      if( lease ) {
+         connection_pool::lease( result, std::move( lease ) );
+      }
+      configure( *result );
+      if( dl ) {
+         result->set_deadline( *dl );
       }
+      connection_pool::apply( *result, key, settings );
+      m_checkout_latency.record( std::chrono::steady_clock::now() - start );
       return result;
    }
 
+   auto connection_pool::statistics() const -> pool_statistics
+   {
+      pool_statistics result;
+      result.idle = size();
+      result.in_use = in_use();
+      result.total = result.idle + result.in_use;
+      result.created = created();
+      result.destroyed = destroyed();
+      result.invalidated = invalidated();
+      result.checkout_latency = m_checkout_latency.snapshot();
+      result.hold_time = hold_time();
+      result.result_memory = connection_pool::result_memory();
+      return result;
+   }
+
+   auto connection_pool::connection( const std::size_t admission_class ) -> std::shared_ptr< pq::connection >
+   {
+      return connection_pool::checkout( admission_class, std::nullopt, {} );
+   }
+
+   auto connection_pool::connection( const std::size_t admission_class, const pq::deadline& dl ) -> std::shared_ptr< pq::connection >
+   {
+      return connection_pool::checkout( admission_class, dl, {} );
+   }
+
+   auto connection_pool::connection( const session_settings& settings ) -> std::shared_ptr< pq::connection >
+   {
+      return connection_pool::checkout( 0, std::nullopt, settings );
+   }
+
+   auto connection_pool::connection( const session_settings& settings, const pq::deadline& dl ) -> std::shared_ptr< pq::connection >
+   {
+      return connection_pool::checkout( 0, dl, settings );
+   }
+
 }  // namespace tao::pq
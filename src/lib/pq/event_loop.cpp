@@ -0,0 +1,182 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#if defined( __linux__ )
+
+#include <tao/pq/event_loop.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace tao::pq
+{
+   event_loop::event_loop( const private_key /*unused*/ )
+      : m_epoll( ::epoll_create1( EPOLL_CLOEXEC ) )
+   {
+      if( m_epoll < 0 ) {
+         // LCOV_EXCL_START
+         const int e = errno;
+         throw std::runtime_error( "epoll_create1() failed: " + internal::errno_to_string( e ) );
+         // LCOV_EXCL_STOP
+      }
+   }
+
+   event_loop::~event_loop()
+   {
+      ::close( m_epoll );
+   }
+
+   auto event_loop::create() -> std::shared_ptr< event_loop >
+   {
+      return std::make_shared< event_loop >( private_key() );
+   }
+
+   void event_loop::v_watch( const int socket, const bool wait_for_write, ready_handler handler, const std::optional< std::chrono::steady_clock::time_point >& end )
+   {
+      epoll_event event = {};
+      event.events = static_cast< std::uint32_t >( EPOLLIN ) | ( wait_for_write ? static_cast< std::uint32_t >( EPOLLOUT ) : std::uint32_t( 0 ) ) | static_cast< std::uint32_t >( EPOLLONESHOT );
+      event.data.fd = socket;
+
+      // sockets stay registered after their one-shot event, so re-arming them is a single call,
+      // closed sockets are removed from the epoll set by the kernel and need to be added again
+      if( ::epoll_ctl( m_epoll, EPOLL_CTL_MOD, socket, &event ) != 0 ) {
+         if( ( errno != ENOENT ) || ( ::epoll_ctl( m_epoll, EPOLL_CTL_ADD, socket, &event ) != 0 ) ) {
+            const int e = errno;
+            throw std::runtime_error( "epoll_ctl() failed: " + internal::errno_to_string( e ) );
+         }
+      }
+
+      const auto timer = end ? m_timers.emplace( *end, socket ) : m_timers.end();
+      const auto it = m_watchers.find( socket );
+      if( it != m_watchers.end() ) {
+         if( it->second.timer != m_timers.end() ) {
+            m_timers.erase( it->second.timer );
+         }
+         it->second = { std::move( handler ), timer };
+      }
+      else {
+         m_watchers.emplace( socket, watcher{ std::move( handler ), timer } );
+      }
+   }
+
+   void event_loop::unwatch( const int socket ) noexcept
+   {
+      const auto it = m_watchers.find( socket );
+      if( it != m_watchers.end() ) {
+         if( it->second.timer != m_timers.end() ) {
+            m_timers.erase( it->second.timer );
+         }
+         m_watchers.erase( it );
+         ::epoll_ctl( m_epoll, EPOLL_CTL_DEL, socket, nullptr );
+      }
+   }
+
+   auto event_loop::fire( const int socket, const internal::poll_status status ) -> bool
+   {
+      const auto it = m_watchers.find( socket );
+      if( it == m_watchers.end() ) {
+         return false;
+      }
+      const auto handler = std::move( it->second.handler );
+      if( it->second.timer != m_timers.end() ) {
+         m_timers.erase( it->second.timer );
+      }
+      m_watchers.erase( it );
+      handler( status );
+      return true;
+   }
+
+   auto event_loop::run_once( const std::optional< std::chrono::milliseconds >& timeout ) -> std::size_t
+   {
+      int wait = timeout ? static_cast< int >( timeout->count() ) : -1;
+      if( !m_timers.empty() ) {
+         const auto remaining = internal::poll_timeout( m_timers.begin()->first );
+         if( ( wait < 0 ) || ( remaining < wait ) ) {
+            wait = remaining;
+         }
+      }
+
+      epoll_event events[ 64 ];
+      const auto n = ::epoll_wait( m_epoll, events, 64, wait );
+      if( n < 0 ) {
+         // LCOV_EXCL_START
+         const int e = errno;
+         if( e == EINTR ) {
+            return 0;
+         }
+         throw std::runtime_error( "epoll_wait() failed: " + internal::errno_to_string( e ) );
+         // LCOV_EXCL_STOP
+      }
+
+      std::size_t count = 0;
+      for( int i = 0; i < n; ++i ) {
+         const auto status = ( ( events[ i ].events & ( EPOLLIN | EPOLLERR | EPOLLHUP ) ) != 0 ) ? internal::poll_status::readable : internal::poll_status::writable;
+         if( event_loop::fire( events[ i ].data.fd, status ) ) {
+            ++count;
+         }
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+      while( !m_timers.empty() && ( m_timers.begin()->first <= now ) ) {
+         if( event_loop::fire( m_timers.begin()->second, internal::poll_status::timeout ) ) {
+            ++count;
+         }
+      }
+      return count;
+   }
+
+   void event_loop::run()
+   {
+      while( !m_watchers.empty() ) {
+         (void)event_loop::run_once();
+      }
+   }
+
+   void event_loop::start( const std::shared_ptr< pq::transaction >& tr,
+                           const std::chrono::steady_clock::time_point start,
+                           result_handler&& on_result,
+                           error_handler&& on_error )
+   {
+      const auto op = std::make_shared< operation >();
+      op->async = std::make_unique< internal::result_operation >( tr, start );
+      op->on_result = std::move( on_result );
+      op->on_error = std::move( on_error );
+      event_loop::step( op, internal::poll_status::again );
+   }
+
+   void event_loop::step( const std::shared_ptr< operation >& op, const internal::poll_status status )
+   {
+      std::optional< pq::result > result;
+      std::exception_ptr error;
+      try {
+         if( !op->async->resume( status ) ) {
+            const auto& async = *op->async;
+            event_loop::watch(
+               async.socket(), async.wait_for_write(), [ this, op ]( const internal::poll_status s ) { event_loop::step( op, s ); }, async.end() );
+            return;
+         }
+         result.emplace( op->async->get() );
+      }
+      catch( ... ) {
+         error = std::current_exception();
+      }
+
+      // release the transaction first, so the handlers can use the connection again
+      op->async.reset();
+      if( error ) {
+         op->on_error( error );
+      }
+      else {
+         op->on_result( std::move( *result ) );
+      }
+   }
+
+}  // namespace tao::pq
+
+#endif
@@ -0,0 +1,297 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/hedged_pool.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <tuple>
+#include <vector>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/exception.hpp>
+#include <tao/pq/internal/async.hpp>
+#include <tao/pq/internal/poll.hpp>
+
+namespace tao::pq
+{
+   namespace
+   {
+      // the adaptive hedge delay requires a minimum number of samples
+      constexpr std::size_t min_samples = 20;
+
+      // abandoned statements which are still running when this limit is
+      // reached are dropped, which also closes their connections
+      constexpr std::size_t max_draining = 16;
+
+      // how long an abandoned statement may take to be cancelled if its connection has no timeout
+      constexpr std::chrono::seconds default_grace_period( 1 );
+
+      // only a broken connection or a timeout is worth another attempt,
+      // other errors, e.g. SQL errors, would occur on the secondary as well
+      [[nodiscard]] auto is_transient( const std::exception_ptr& e ) -> bool
+      {
+         try {
+            std::rethrow_exception( e );
+         }
+         catch( const connection_error& ) {
+            return true;
+         }
+         catch( const timeout_reached& ) {
+            return true;
+         }
+         catch( ... ) {
+            return false;
+         }
+      }
+
+   }  // namespace
+
+   struct hedged_pool::attempt final
+   {
+      std::shared_ptr< pq::connection > connection;
+      std::unique_ptr< internal::result_operation > operation;
+      std::optional< internal::poll_status > ready = internal::poll_status::again;
+   };
+
+   hedged_pool::hedged_pool( const private_key /*unused*/, const std::shared_ptr< connection_pool >& primary, const std::shared_ptr< connection_pool >& secondary )  // NOLINT(modernize-pass-by-value)
+      : m_primary( primary ),
+        m_secondary( secondary ),
+        m_latencies(),
+        m_samples( 0 ),
+        m_hedges( 0 ),
+        m_failovers( 0 ),
+        m_secondary_wins( 0 )
+   {}
+
+   hedged_pool::~hedged_pool()
+   {
+      try {
+         hedged_pool::drain( true );
+      }
+      // LCOV_EXCL_START
+      catch( ... ) {
+         // the remaining connections are closed
+      }
+      // LCOV_EXCL_STOP
+   }
+
+   auto hedged_pool::create( const std::shared_ptr< connection_pool >& primary, const std::shared_ptr< connection_pool >& secondary ) -> std::shared_ptr< hedged_pool >
+   {
+      return std::make_shared< hedged_pool >( private_key(), primary, secondary );
+   }
+
+   void hedged_pool::set_hedge_delay( const std::chrono::microseconds delay )
+   {
+      const std::lock_guard lock( m_mutex );
+      m_hedge_delay = delay;
+   }
+
+   void hedged_pool::reset_hedge_delay() noexcept
+   {
+      const std::lock_guard lock( m_mutex );
+      m_hedge_delay = std::nullopt;
+   }
+
+   auto hedged_pool::hedge_delay() const -> std::optional< std::chrono::microseconds >
+   {
+      const std::lock_guard lock( m_mutex );
+      if( m_hedge_delay ) {
+         return m_hedge_delay;
+      }
+      const auto n = std::min( m_samples, m_latencies.size() );
+      if( n < min_samples ) {
+         return std::nullopt;
+      }
+      auto latencies = m_latencies;
+      const auto p95 = latencies.begin() + ( n * 95 / 100 );
+      std::nth_element( latencies.begin(), p95, latencies.begin() + n );
+      return *p95;
+   }
+
+   void hedged_pool::record( const std::chrono::microseconds latency )
+   {
+      const std::lock_guard lock( m_mutex );
+      m_latencies[ m_samples % m_latencies.size() ] = latency;
+      ++m_samples;
+   }
+
+   void hedged_pool::abandon( std::unique_ptr< attempt >&& a )
+   {
+      // the cancel request is sent without blocking to return the winning result immediately,
+      // the connection is only reused after the cancel request was sent
+      try {
+         a->operation->abandon( std::chrono::steady_clock::now() + a->connection->timeout().value_or( default_grace_period ) );
+      }
+      catch( ... ) {
+         return;  // the statement is already done, its connection is returned to its pool
+      }
+      std::unique_ptr< attempt > dropped;
+      const std::lock_guard lock( m_mutex );
+      m_draining.push_back( std::move( a ) );
+      if( m_draining.size() > max_draining ) {
+         dropped = std::move( m_draining.front() );
+         m_draining.pop_front();
+      }
+   }
+
+   void hedged_pool::drain( const bool wait )
+   {
+      // connections are returned to their pool when the list is destroyed, outside of the lock
+      std::list< std::unique_ptr< attempt > > done;
+      const std::lock_guard lock( m_mutex );
+      while( !m_draining.empty() ) {
+         std::optional< std::chrono::steady_clock::time_point > end;
+         std::vector< internal::poll_item > items;
+         for( const auto& a : m_draining ) {
+            items.push_back( { a->operation->socket(), a->operation->wait_for_write(), internal::poll_status::timeout } );
+            if( const auto& e = a->operation->end() ) {
+               end = end ? std::min( *end, *e ) : *e;
+            }
+         }
+         std::ignore = internal::poll( items, !wait ? 0 : ( end ? internal::poll_timeout( *end ) : -1 ) );
+
+         const auto now = std::chrono::steady_clock::now();
+         auto item = items.begin();
+         auto it = m_draining.begin();
+         while( it != m_draining.end() ) {
+            auto& a = **it;
+            std::optional< internal::poll_status > ready;
+            if( item->status != internal::poll_status::timeout ) {
+               ready = item->status;
+            }
+            else if( const auto& e = a.operation->end(); e && ( now >= *e ) ) {
+               ready = internal::poll_status::timeout;
+            }
+            ++item;
+            if( ready ) {
+               try {
+                  if( !a.operation->resume( *ready ) ) {
+                     ++it;
+                     continue;
+                  }
+               }
+               catch( ... ) {
+                  // the expected outcome of a cancelled statement
+               }
+               done.splice( done.end(), m_draining, it++ );
+            }
+            else {
+               ++it;
+            }
+         }
+         if( !wait ) {
+            break;
+         }
+      }
+   }
+
+   auto hedged_pool::execute_hedged( const std::function< void( transaction& ) >& send ) -> result
+   {
+      hedged_pool::drain( false );
+
+      const auto delay = hedged_pool::hedge_delay();
+      const auto start = std::chrono::steady_clock::now();
+
+      std::array< std::unique_ptr< attempt >, 2 > attempts;
+      std::exception_ptr error;
+      bool hedged = false;
+
+      const auto launch = [ & ]( const std::size_t i ) {
+         if( i == 1 ) {
+            hedged = true;
+         }
+         try {
+            auto a = std::make_unique< attempt >();
+            a->connection = ( ( i == 0 ) ? m_primary : m_secondary )->connection();
+            const auto tr = a->connection->direct();
+            send( *tr );
+            a->operation = std::make_unique< internal::result_operation >( tr, std::chrono::steady_clock::now() );
+            attempts[ i ] = std::move( a );
+         }
+         catch( ... ) {
+            error = std::current_exception();
+         }
+      };
+
+      launch( 0 );
+      while( true ) {
+         for( std::size_t i = 0; i < attempts.size(); ++i ) {
+            auto& a = attempts[ i ];
+            if( !a || !a->ready ) {
+               continue;
+            }
+            try {
+               if( a->operation->resume( *a->ready ) ) {
+                  auto r = a->operation->get();
+                  hedged_pool::record( std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - start ) );
+                  if( i == 1 ) {
+                     m_secondary_wins.fetch_add( 1, std::memory_order_relaxed );
+                  }
+                  if( auto& loser = attempts[ 1 - i ] ) {
+                     hedged_pool::abandon( std::move( loser ) );
+                  }
+                  return r;
+               }
+               a->ready = std::nullopt;
+            }
+            catch( ... ) {
+               error = std::current_exception();
+               a.reset();
+               if( !is_transient( error ) ) {
+                  if( auto& other = attempts[ 1 - i ] ) {
+                     hedged_pool::abandon( std::move( other ) );
+                  }
+                  std::rethrow_exception( error );
+               }
+               // otherwise wait for the other attempt, if any
+            }
+         }
+
+         if( !attempts[ 0 ] && !attempts[ 1 ] ) {
+            if( hedged || !is_transient( error ) ) {
+               std::rethrow_exception( error );
+            }
+            // the primary failed, fail over immediately
+            m_failovers.fetch_add( 1, std::memory_order_relaxed );
+            launch( 1 );
+            continue;
+         }
+
+         std::optional< std::chrono::steady_clock::time_point > end;
+         if( !hedged && delay ) {
+            end = start + *delay;
+         }
+         std::vector< internal::poll_item > items;
+         for( const auto& a : attempts ) {
+            if( a ) {
+               items.push_back( { a->operation->socket(), a->operation->wait_for_write(), internal::poll_status::timeout } );
+               if( const auto& e = a->operation->end() ) {
+                  end = end ? std::min( *end, *e ) : *e;
+               }
+            }
+         }
+         std::ignore = internal::poll( items, end ? internal::poll_timeout( *end ) : -1 );
+
+         const auto now = std::chrono::steady_clock::now();
+         auto item = items.begin();
+         for( const auto& a : attempts ) {
+            if( a ) {
+               if( item->status != internal::poll_status::timeout ) {
+                  a->ready = item->status;
+               }
+               else if( const auto& e = a->operation->end(); e && ( now >= *e ) ) {
+                  a->ready = internal::poll_status::timeout;
+               }
+               ++item;
+            }
+         }
+         if( !hedged && delay && ( now >= start + *delay ) ) {
+            m_hedges.fetch_add( 1, std::memory_order_relaxed );
+            launch( 1 );
+         }
+      }
+   }
+
+}  // namespace tao::pq
@@ -0,0 +1,259 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/internal/admission.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <tao/pq/exception.hpp>
+
+namespace tao::pq::internal
+{
+   namespace
+   {
+      // each admission advances a class' virtual time inversely proportional to its weight
+      constexpr std::uint64_t stride = 1 << 20;
+
+      // adaptive sizing re-evaluates the limit once per interval
+      constexpr std::chrono::milliseconds interval( 100 );
+
+      // hold times above this multiple of the baseline indicate an overloaded server
+      constexpr std::int64_t tolerance = 2;
+
+      // the limit is not reduced below the estimate from Little's law times this headroom
+      constexpr double headroom = 1.5;
+
+   }  // namespace
+
+   admission::admission( const std::size_t max_connections, const std::vector< admission_class >& classes, const admission_policy policy )
+      : m_policy( policy ),
+        m_limit( max_connections ),
+        m_in_use( 0 ),
+        m_virtual_time( 0 )
+   {
+      if( max_connections == 0 ) {
+         throw std::invalid_argument( "invalid maximum number of connections" );
+      }
+      if( classes.empty() ) {
+         throw std::invalid_argument( "no admission classes" );
+      }
+      m_classes.resize( classes.size() );
+      for( std::size_t i = 0; i < classes.size(); ++i ) {
+         if( ( classes[ i ].weight == 0 ) || ( classes[ i ].weight > stride ) ) {
+            throw std::invalid_argument( "invalid weight for admission class " + classes[ i ].name );
+         }
+         if( classes[ i ].max_concurrency == 0 ) {
+            throw std::invalid_argument( "invalid maximum concurrency for admission class " + classes[ i ].name );
+         }
+         m_classes[ i ].config = classes[ i ];
+         m_classes[ i ].statistics.name = classes[ i ].name;
+      }
+   }
+
+   auto admission::eligible( const std::size_t index ) const noexcept -> bool
+   {
+      const auto& c = m_classes[ index ];
+      return !c.waiting.empty() && ( c.statistics.in_use < c.config.max_concurrency );
+   }
+
+   auto admission::select() const noexcept -> std::optional< std::size_t >
+   {
+      if( m_in_use >= m_limit ) {
+         return std::nullopt;
+      }
+      std::optional< std::size_t > result;
+      for( std::size_t i = 0; i < m_classes.size(); ++i ) {
+         if( !admission::eligible( i ) ) {
+            continue;
+         }
+         if( m_policy == admission_policy::strict_priority ) {
+            return i;
+         }
+         if( !result || ( m_classes[ i ].pass < m_classes[ *result ].pass ) ) {
+            result = i;
+         }
+      }
+      return result;
+   }
+
+   void admission::grant( const std::size_t index ) noexcept
+   {
+      auto& c = m_classes[ index ];
+      waiter* w = c.waiting.front();
+      c.waiting.pop_front();
+      --c.statistics.waiting;
+      ++c.statistics.in_use;
+      ++c.statistics.admitted;
+      ++m_in_use;
+      m_window.peak_in_use = std::max( m_window.peak_in_use, m_in_use );
+      m_virtual_time = c.pass;
+      c.pass += stride / c.config.weight;
+      w->granted = true;
+      w->condition.notify_one();
+   }
+
+   void admission::dispatch() noexcept
+   {
+      while( const auto index = admission::select() ) {
+         admission::grant( *index );
+      }
+   }
+
+   void admission::release( const std::size_t index, const std::chrono::steady_clock::time_point since ) noexcept
+   {
+      const auto now = std::chrono::steady_clock::now();
+      const std::lock_guard lock( m_mutex );
+      --m_classes[ index ].statistics.in_use;
+      --m_in_use;
+      ++m_window.released;
+      m_window.hold += std::chrono::duration_cast< std::chrono::microseconds >( now - since );
+      admission::adapt( now );
+      admission::dispatch();
+   }
+
+   // additive increase while requests queue and the server keeps up, multiplicative decrease
+   // when the hold times grow beyond the baseline, and a slow decay towards the estimate from
+   // Little's law when the limit is not used
+   void admission::adapt( const std::chrono::steady_clock::time_point now ) noexcept
+   {
+      if( !m_sizing || ( now - m_window.start < interval ) ) {
+         return;
+      }
+      const auto [ min, max ] = *m_sizing;
+      auto& s = m_sizing_statistics;
+      const auto seconds = std::chrono::duration< double >( now - m_window.start ).count();
+      s.arrival_rate = static_cast< double >( m_window.admitted ) / seconds;
+      s.average_wait = ( m_window.admitted == 0 ) ? std::chrono::microseconds() : ( m_window.wait / static_cast< std::int64_t >( m_window.admitted ) );
+      s.average_hold = ( m_window.released == 0 ) ? std::chrono::microseconds() : ( m_window.hold / static_cast< std::int64_t >( m_window.released ) );
+      s.estimate = s.arrival_rate * std::chrono::duration< double >( s.average_hold ).count();
+      if( m_window.released != 0 ) {
+         // the baseline follows decreases immediately and increases slowly
+         if( ( s.baseline_hold.count() == 0 ) || ( s.average_hold < s.baseline_hold ) ) {
+            s.baseline_hold = s.average_hold;
+         }
+         else {
+            s.baseline_hold += ( s.average_hold - s.baseline_hold ) / 64;
+         }
+      }
+
+      if( ( m_window.released != 0 ) && ( s.average_hold > s.baseline_hold * tolerance ) && ( m_limit > min ) ) {
+         m_limit = std::max( min, m_limit * 3 / 4 );
+         ++s.decreases;
+      }
+      else if( m_window.queued && ( m_window.peak_in_use >= m_limit ) && ( m_limit < max ) ) {
+         ++m_limit;
+         ++s.increases;
+      }
+      else if( !m_window.queued && ( m_window.peak_in_use < m_limit ) && ( m_limit > min ) && ( s.estimate * headroom < static_cast< double >( m_limit - 1 ) ) ) {
+         --m_limit;
+         ++s.decreases;
+      }
+      s.limit = m_limit;
+
+      m_window = window();
+      m_window.start = now;
+      m_window.peak_in_use = m_in_use;
+      for( const auto& c : m_classes ) {
+         m_window.queued = m_window.queued || !c.waiting.empty();
+      }
+   }
+
+   auto admission::limit() const -> std::size_t
+   {
+      const std::lock_guard lock( m_mutex );
+      return m_limit;
+   }
+
+   void admission::set_sizing( const std::size_t min_connections, const std::size_t max_connections )
+   {
+      if( ( min_connections == 0 ) || ( min_connections > max_connections ) ) {
+         throw std::invalid_argument( "invalid pool size limits" );
+      }
+      const std::lock_guard lock( m_mutex );
+      m_sizing.emplace( min_connections, max_connections );
+      m_limit = std::clamp( m_limit, min_connections, max_connections );
+      m_sizing_statistics = sizing_statistics();
+      m_sizing_statistics.limit = m_limit;
+      m_sizing_statistics.min_connections = min_connections;
+      m_sizing_statistics.max_connections = max_connections;
+      m_window = window();
+      m_window.start = std::chrono::steady_clock::now();
+      m_window.peak_in_use = m_in_use;
+      admission::dispatch();
+   }
+
+   void admission::reset_sizing() noexcept
+   {
+      const std::lock_guard lock( m_mutex );
+      m_sizing = std::nullopt;
+   }
+
+   auto admission::sizing() const -> std::optional< sizing_statistics >
+   {
+      const std::lock_guard lock( m_mutex );
+      if( m_sizing ) {
+         return m_sizing_statistics;
+      }
+      return std::nullopt;
+   }
+
+   auto admission::acquire( const std::size_t index, const std::optional< std::chrono::steady_clock::time_point >& end ) -> std::shared_ptr< void >
+   {
+      if( index >= m_classes.size() ) {
+         throw std::invalid_argument( "invalid admission class" );
+      }
+      const auto start = std::chrono::steady_clock::now();
+      std::unique_lock lock( m_mutex );
+      auto& c = m_classes[ index ];
+
+      // a class which was idle must not use up the share it did not claim meanwhile
+      if( c.waiting.empty() ) {
+         c.pass = std::max( c.pass, m_virtual_time );
+      }
+      waiter w;
+      c.waiting.push_back( &w );
+      ++c.statistics.waiting;
+      admission::adapt( start );
+      admission::dispatch();
+      if( !w.granted ) {
+         m_window.queued = true;
+      }
+
+      while( !w.granted ) {
+         if( !end ) {
+            w.condition.wait( lock );
+         }
+         else if( ( w.condition.wait_until( lock, *end ) == std::cv_status::timeout ) && !w.granted ) {
+            c.waiting.remove( &w );
+            --c.statistics.waiting;
+            ++c.statistics.rejected;
+            throw timeout_reached( "deadline reached while waiting for admission" );
+         }
+      }
+
+      const auto wait = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - start );
+      c.statistics.total_wait += wait;
+      c.statistics.max_wait = std::max( c.statistics.max_wait, wait );
+      ++m_window.admitted;
+      m_window.wait += wait;
+      lock.unlock();
+
+      // the deleter is also called when allocating the control block fails
+      const auto since = std::chrono::steady_clock::now();
+      return std::shared_ptr< void >( nullptr, [ self = shared_from_this(), index, since ]( void* /*unused*/ ) { self->release( index, since ); } );
+   }
+
+   auto admission::statistics() const -> std::vector< admission_statistics >
+   {
+      std::vector< admission_statistics > result;
+      const std::lock_guard lock( m_mutex );
+      result.reserve( m_classes.size() );
+      for( const auto& c : m_classes ) {
+         result.push_back( c.statistics );
+      }
+      return result;
+   }
+
+}  // namespace tao::pq::internal
@@ -0,0 +1,402 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <tao/pq/cancel_handle.hpp>
+#include <tao/pq/connection.hpp>
+#include <tao/pq/exception.hpp>
+#include <tao/pq/internal/async.hpp>
+#include <tao/pq/table_reader.hpp>
+#include <tao/pq/table_writer.hpp>
+#include <tao/pq/transaction.hpp>
+
+namespace tao::pq::internal
+{
+   async_base::async_base( const std::shared_ptr< pq::connection >& connection, const std::chrono::steady_clock::time_point start )
+      : m_connection( connection ),
+        m_cancelling( false ),
+        m_wait_for_write( false )
+   {
+      if( m_connection->has_timeout() ) {
+         m_end = m_connection->timeout_end( start );
+      }
+   }
+
+   auto async_base::pgconn() const noexcept -> PGconn*
+   {
+      return m_connection->underlying_raw_ptr();
+   }
+
+   auto async_base::make_result( PGresult* pgresult ) const -> pq::result
+   {
+      return pq::result( pgresult, m_connection->m_result_memory );
+   }
+
+   auto async_base::flush() -> bool
+   {
+      switch( PQflush( pgconn() ) ) {
+         case 0:
+            return true;
+
+         case 1:
+            ++m_connection->m_io.flush_retries;
+            m_wait_for_write = true;
+            return false;
+
+            // LCOV_EXCL_START
+         default:
+            throw std::runtime_error( "PQflush() failed: " + m_connection->error_message() );
+            // LCOV_EXCL_STOP
+      }
+   }
+
+   // same result processing as transaction::get_result(), but without blocking
+   auto async_base::fetch( std::unique_ptr< PGresult, decltype( &PQclear ) >& result ) -> bool
+   {
+      while( PQisBusy( pgconn() ) == 0 ) {
+         std::unique_ptr< PGresult, decltype( &PQclear ) > next( PQgetResult( pgconn() ), &PQclear );
+         if( !next ) {
+            m_connection->check_result_limit( result.get() );
+            return true;
+         }
+         m_connection->io_received( PQresultMemorySize( next.get() ) );
+         switch( PQresultStatus( next.get() ) ) {
+            case PGRES_COPY_IN:
+               m_connection->put_copy_end( "unexpected COPY FROM statement" );
+               break;
+
+            case PGRES_COPY_OUT:
+               return cancel( std::make_exception_ptr( std::runtime_error( "unexpected COPY TO statement" ) ), m_end );
+
+            default:;
+         }
+         if( const auto size = m_connection->collect_rows( result, std::move( next ) ) ) {
+            return cancel( std::make_exception_ptr( result_limit_exceeded( m_connection->result_limit_message( *size ) ) ), m_end );
+         }
+      }
+      m_wait_for_write = false;
+      return false;
+   }
+
+   void async_base::hook_sent()
+   {
+      if( m_connection->m_hooks ) {
+         m_connection->hook_sent();
+      }
+   }
+
+   void async_base::hook_result( const PGresult* result )
+   {
+      if( m_connection->m_hooks ) {
+         m_connection->hook_result( result );
+      }
+   }
+
+   void async_base::received_copy_data( const std::size_t received ) noexcept
+   {
+      m_connection->io_received( received );
+      m_connection->hook_copy_data( 0, received );
+   }
+
+   void async_base::copy_end_sent() noexcept
+   {
+      m_connection->m_io_sent = true;
+   }
+
+   auto async_base::scheduler() const -> const std::shared_ptr< pq::scheduler >&
+   {
+      const auto& result = m_connection->scheduler();
+      if( !result ) {
+         throw std::logic_error( "invalid asynchronous operation, no scheduler set" );
+      }
+      return result;
+   }
+
+   auto async_base::socket() const -> int
+   {
+      return m_cancel ? m_cancel->socket() : m_connection->socket();
+   }
+
+   // unlike connection::reset_after_timeout(), the cancel request is sent and the results are
+   // cleared by the state machine, so the caller's thread never blocks
+   auto async_base::cancel( const std::exception_ptr& reason, const std::optional< std::chrono::steady_clock::time_point >& grace_end ) -> bool
+   {
+      m_cancelling = true;
+      m_grace_end = grace_end;
+      m_reason = reason;
+      try {
+         m_cancel = m_connection->cancel_handle();
+         m_cancel->start();
+      }
+      // LCOV_EXCL_START
+      catch( ... ) {
+         aborted( false );
+      }
+      // LCOV_EXCL_STOP
+      return cancelled( poll_status::again );
+   }
+
+   // discards the remaining results of the cancelled statement, returns false when it needs to wait for the socket
+   auto async_base::drain() -> bool
+   {
+      if( !flush() ) {
+         return false;
+      }
+      if( PQconsumeInput( pgconn() ) == 0 ) {
+         throw pq::connection_error( PQerrorMessage( pgconn() ) );
+      }
+      while( PQisBusy( pgconn() ) == 0 ) {
+         const std::unique_ptr< PGresult, decltype( &PQclear ) > result( PQgetResult( pgconn() ), &PQclear );
+         if( !result ) {
+            return true;
+         }
+         switch( PQresultStatus( result.get() ) ) {
+            case PGRES_COPY_IN:
+               switch( PQputCopyEnd( pgconn(), "statement cancelled" ) ) {
+                  case 1:
+                     if( !flush() ) {
+                        return false;
+                     }
+                     break;
+
+                  case 0:
+                     m_wait_for_write = true;
+                     return false;
+
+                  default:
+                     throw std::runtime_error( "PQputCopyEnd() failed: " + m_connection->error_message() );
+               }
+               break;
+
+            case PGRES_COPY_OUT: {
+               char* buffer = nullptr;
+               int size;
+               while( ( size = PQgetCopyData( pgconn(), &buffer, 1 ) ) > 0 ) {
+                  PQfreemem( buffer );
+               }
+               if( size == 0 ) {
+                  m_wait_for_write = false;
+                  return false;
+               }
+               if( size != -1 ) {
+                  throw std::runtime_error( "PQgetCopyData() failed: " + m_connection->error_message() );
+               }
+               break;
+            }
+
+            default:;
+         }
+      }
+      m_wait_for_write = false;
+      return false;
+   }
+
+   auto async_base::cancelled( const poll_status status ) -> bool
+   {
+      if( ( status == poll_status::timeout ) && m_grace_end && ( std::chrono::steady_clock::now() >= *m_grace_end ) ) {
+         aborted( false );
+      }
+      try {
+         if( m_cancel ) {
+            // wait for the cancel request's socket first, unless there is none to wait for
+            if( ( ( status == poll_status::again ) && ( m_cancel->socket() >= 0 ) ) || !m_cancel->poll() ) {
+               m_wait_for_write = m_cancel->wait_for_write();
+               m_end = m_grace_end;
+               return false;
+            }
+            // the connection may only be used again after the cancel request was sent,
+            // otherwise it might abort the next statement
+            m_cancel.reset();
+         }
+         if( !drain() ) {
+            m_end = m_grace_end;
+            return false;
+         }
+      }
+      catch( ... ) {
+         aborted( false );
+      }
+      aborted( true );
+   }
+
+   void async_base::aborted( const bool keep_connection )
+   {
+      m_cancelling = false;
+      m_cancel.reset();
+      if( !keep_connection ) {
+         m_connection->m_pgconn.reset();
+      }
+      hook_result( nullptr );
+      std::rethrow_exception( std::exchange( m_reason, nullptr ) );
+   }
+
+   auto async_base::resume( const poll_status status ) -> bool
+   {
+      if( m_cancelling ) {
+         return cancelled( status );
+      }
+      switch( status ) {
+         case poll_status::timeout: {
+            auto reason = std::make_exception_ptr( timeout_reached( "timeout reached" ) );
+            if( !m_connection->m_cancel_on_timeout || ( PQpipelineStatus( pgconn() ) != PQ_PIPELINE_OFF ) ) {
+               m_reason = std::move( reason );
+               aborted( false );
+            }
+            return cancel( reason, std::chrono::steady_clock::now() + *m_connection->m_cancel_on_timeout );
+         }
+
+         case poll_status::readable:
+            m_connection->get_notifications();
+            if( m_connection->m_hooks ) {
+               m_connection->hook_first_byte();
+            }
+            break;
+
+         default:;
+      }
+      return v_resume();
+   }
+
+   void async_base::abandon( const std::chrono::steady_clock::time_point end )
+   {
+      if( !m_cancelling ) {
+         std::ignore = cancel( std::make_exception_ptr( std::runtime_error( "statement abandoned" ) ), end );
+      }
+   }
+
+   result_operation::result_operation( const std::shared_ptr< pq::transaction >& tr, const std::chrono::steady_clock::time_point start )
+      : async_operation( tr->connection(), start ),
+        m_transaction( tr ),
+        m_result( nullptr, &PQclear ),
+        m_flushed( false )
+   {}
+
+   auto result_operation::v_resume() -> bool
+   {
+      if( !m_flushed ) {
+         if( !flush() ) {
+            return false;
+         }
+         m_flushed = true;
+         hook_sent();
+      }
+      return fetch( m_result );
+   }
+
+   auto result_operation::v_get() -> pq::result
+   {
+      hook_result( m_result.get() );
+      // release the transaction first, the connection can then be used again
+      m_transaction.reset();
+      return make_result( m_result.release() );
+   }
+
+   table_row_operation::table_row_operation( table_reader& reader )
+      : async_operation( reader.m_transaction->connection(), std::chrono::steady_clock::now() ),
+        m_reader( reader ),
+        m_result( nullptr, &PQclear ),
+        m_finished( false )
+   {}
+
+   auto table_row_operation::v_resume() -> bool
+   {
+      if( !m_finished ) {
+         char* buffer = nullptr;
+         const auto size = PQgetCopyData( pgconn(), &buffer, 1 );
+         if( size > 0 ) {
+            received_copy_data( static_cast< std::size_t >( size ) );
+            m_reader.m_buffer.reset( buffer );
+            return true;
+         }
+         switch( size ) {
+            case 0:
+               m_wait_for_write = false;
+               return false;
+
+            case -1:
+               m_reader.m_buffer.reset();
+               m_finished = true;
+               break;
+
+               // LCOV_EXCL_START
+            default:
+               throw std::runtime_error( "PQgetCopyData() failed: " + connection()->error_message() );
+               // LCOV_EXCL_STOP
+         }
+      }
+      return fetch( m_result );
+   }
+
+   auto table_row_operation::v_get() -> bool
+   {
+      if( m_finished ) {
+         hook_result( m_result.get() );
+         std::ignore = make_result( m_result.release() );
+         m_reader.m_transaction.reset();
+         m_reader.m_previous.reset();
+      }
+      return m_reader.parse_data();
+   }
+
+   table_flush_operation::table_flush_operation( table_writer& writer )
+      : async_operation( writer.m_transaction->connection(), std::chrono::steady_clock::now() )
+   {
+      m_wait_for_write = true;
+   }
+
+   auto table_flush_operation::v_resume() -> bool
+   {
+      return flush();
+   }
+
+   table_commit_operation::table_commit_operation( table_writer& writer )
+      : async_operation( writer.m_transaction->connection(), std::chrono::steady_clock::now() ),
+        m_writer( writer ),
+        m_result( nullptr, &PQclear ),
+        m_ended( false ),
+        m_flushed( false )
+   {}
+
+   auto table_commit_operation::v_resume() -> bool
+   {
+      if( !m_ended ) {
+         switch( PQputCopyEnd( pgconn(), nullptr ) ) {
+            case 1:
+               copy_end_sent();
+               m_ended = true;
+               break;
+
+               // LCOV_EXCL_START
+            case 0:
+               m_wait_for_write = true;
+               return false;
+
+            default:
+               throw std::runtime_error( "PQputCopyEnd() failed: " + connection()->error_message() );
+               // LCOV_EXCL_STOP
+         }
+      }
+      if( !m_flushed ) {
+         if( !flush() ) {
+            return false;
+         }
+         m_flushed = true;
+      }
+      return fetch( m_result );
+   }
+
+   auto table_commit_operation::v_get() -> std::size_t
+   {
+      hook_result( m_result.get() );
+      const auto rows_affected = make_result( m_result.release() ).rows_affected();
+      m_writer.m_transaction.reset();
+      m_writer.m_previous.reset();
+      return rows_affected;
+   }
+
+}  // namespace tao::pq::internal
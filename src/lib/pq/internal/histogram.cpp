@@ -0,0 +1,26 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/internal/histogram.hpp>
+
+namespace tao::pq::internal
+{
+   auto histogram::snapshot() const -> latency_histogram
+   {
+      latency_histogram result;
+      result.bounds.reserve( bounds );
+      result.counts.reserve( bounds + 1 );
+      for( std::size_t i = 0; i < bounds; ++i ) {
+         result.bounds.emplace_back( bound( i ) );
+      }
+      // the count is the sum of the buckets, so a snapshot is consistent even while values are recorded
+      for( const auto& c : m_counts ) {
+         result.counts.push_back( c.load( std::memory_order_relaxed ) );
+         result.count += result.counts.back();
+      }
+      result.sum = std::chrono::microseconds( m_sum.load( std::memory_order_relaxed ) );
+      return result;
+   }
+
+}  // namespace tao::pq::internal
@@ -0,0 +1,178 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined( _WIN32 )
+#include <winsock2.h>
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+#include <tao/pq/internal/poll.hpp>
+#include <tao/pq/internal/printf.hpp>
+#include <tao/pq/internal/unreachable.hpp>
+
+namespace tao::pq::internal
+{
+   namespace
+   {
+      // LCOV_EXCL_START
+      [[nodiscard, maybe_unused]] auto errno_result_to_string( const int e, char* buffer, int result ) -> std::string
+      {
+         if( result == 0 ) {
+            return buffer;
+         }
+         return internal::printf( "unknown error code %d", e );
+      }
+
+      [[nodiscard, maybe_unused]] auto errno_result_to_string( const int /*unused*/, char* /*unused*/, char* result ) -> std::string
+      {
+         return result;
+      }
+      // LCOV_EXCL_STOP
+
+   }  // namespace
+
+   // LCOV_EXCL_START
+   auto errno_to_string( const int e ) -> std::string
+   {
+      char buffer[ 256 ];
+#if defined( _WIN32 )
+	#ifdef _MSC_VER
+		  return errno_result_to_string( e, buffer, strerror_s( buffer, e ) );
+	#else
+		  return errno_result_to_string( e, buffer, strerror_s(buffer, sizeof (buffer), e));
+	#endif
+#else
+      return errno_result_to_string( e, buffer, strerror_r( e, buffer, sizeof( buffer ) ) );
+#endif
+   }
+   // LCOV_EXCL_STOP
+
+   auto poll( const int socket, const bool wait_for_write, const int timeout ) -> poll_status
+   {
+      const short events = POLLIN | ( wait_for_write ? POLLOUT : 0 );
+
+#if defined( _WIN32 )
+
+      WSAPOLLFD pfd = { static_cast< SOCKET >( socket ), events, 0 };
+      const auto result = WSAPoll( &pfd, 1, timeout );
+      switch( result ) {
+         case 0:
+            return poll_status::timeout;
+
+         case 1:
+            if( ( pfd.revents & events ) == 0 ) {
+               throw std::runtime_error( internal::printf( "WSAPoll() failed, events %hd, revents %hd", events, pfd.revents ) );
+            }
+            return ( ( pfd.revents & POLLIN ) != 0 ) ? poll_status::readable : poll_status::writable;
+
+         case SOCKET_ERROR:
+            break;
+
+         default:
+            TAO_PQ_UNREACHABLE;
+      }
+
+      const int e = WSAGetLastError();
+      throw std::runtime_error( "WSAPoll() failed: " + internal::errno_to_string( e ) );
+
+#else
+
+      pollfd pfd = { socket, events, 0 };
+      errno = 0;
+      const auto result = ::poll( &pfd, 1, timeout );
+      switch( result ) {
+         case 0:
+            return poll_status::timeout;
+
+         case 1:
+            if( ( pfd.revents & events ) == 0 ) {
+               throw std::runtime_error( internal::printf( "poll() failed, events %hd, revents %hd", events, pfd.revents ) );  // LCOV_EXCL_LINE
+            }
+            return ( ( pfd.revents & POLLIN ) != 0 ) ? poll_status::readable : poll_status::writable;
+
+            // LCOV_EXCL_START
+         case -1:
+            break;
+
+         default:
+            TAO_PQ_UNREACHABLE;
+      }
+
+      const int e = errno;
+      if( ( e != EINTR ) && ( e != EAGAIN ) ) {
+         throw std::runtime_error( "poll() failed: " + internal::errno_to_string( e ) );
+      }
+      return poll_status::again;
+      // LCOV_EXCL_STOP
+
+#endif
+   }
+
+   auto poll( std::vector< poll_item >& items, const int timeout ) -> std::size_t
+   {
+#if defined( _WIN32 )
+      std::vector< WSAPOLLFD > pfds;
+      pfds.reserve( items.size() );
+      for( const auto& item : items ) {
+         pfds.push_back( { static_cast< SOCKET >( item.socket ), static_cast< short >( POLLIN | ( item.wait_for_write ? POLLOUT : 0 ) ), 0 } );
+      }
+      const auto result = WSAPoll( pfds.data(), static_cast< ULONG >( pfds.size() ), timeout );
+      if( result == SOCKET_ERROR ) {
+         const int e = WSAGetLastError();
+         throw std::runtime_error( "WSAPoll() failed: " + internal::errno_to_string( e ) );
+      }
+#else
+      std::vector< pollfd > pfds;
+      pfds.reserve( items.size() );
+      for( const auto& item : items ) {
+         pfds.push_back( { item.socket, static_cast< short >( POLLIN | ( item.wait_for_write ? POLLOUT : 0 ) ), 0 } );
+      }
+      errno = 0;
+      const auto result = ::poll( pfds.data(), pfds.size(), timeout );
+      if( result == -1 ) {
+         // LCOV_EXCL_START
+         const int e = errno;
+         if( ( e != EINTR ) && ( e != EAGAIN ) ) {
+            throw std::runtime_error( "poll() failed: " + internal::errno_to_string( e ) );
+         }
+         for( auto& item : items ) {
+            item.status = poll_status::timeout;
+         }
+         return 0;
+         // LCOV_EXCL_STOP
+      }
+#endif
+      for( std::size_t i = 0; i < items.size(); ++i ) {
+         const auto revents = pfds[ i ].revents;
+         if( revents == 0 ) {
+            items[ i ].status = poll_status::timeout;
+         }
+         else if( ( ( revents & POLLOUT ) != 0 ) && ( ( revents & POLLIN ) == 0 ) ) {
+            items[ i ].status = poll_status::writable;
+         }
+         else {
+            items[ i ].status = poll_status::readable;
+         }
+      }
+      return static_cast< std::size_t >( result );
+   }
+
+   void set_busy_poll( [[maybe_unused]] const int socket, [[maybe_unused]] const std::chrono::microseconds timeout ) noexcept
+   {
+#if defined( SO_BUSY_POLL )
+      if( socket >= 0 ) {
+         const int value = static_cast< int >( timeout.count() );
+         (void)::setsockopt( socket, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof( value ) );
+      }
+#endif
+   }
+
+}  // namespace tao::pq::internal
@@ -0,0 +1,45 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <exception>
+
+#include <tao/pq/internal/single_flight.hpp>
+
+namespace tao::pq::internal
+{
+   auto single_flight::execute( const std::string& key, const std::function< result() >& f ) -> result
+   {
+      std::promise< result > promise;
+      {
+         std::unique_lock lock( m_mutex );
+         const auto it = m_in_flight.find( key );
+         if( it != m_in_flight.end() ) {
+            const auto future = it->second;
+            lock.unlock();
+            m_hits.fetch_add( 1, std::memory_order_relaxed );
+            return future.get();
+         }
+         m_in_flight.emplace( key, promise.get_future().share() );
+      }
+      m_misses.fetch_add( 1, std::memory_order_relaxed );
+
+      // later calls start a new flight, only concurrent calls share the outcome
+      const auto done = [ & ] {
+         const std::lock_guard lock( m_mutex );
+         m_in_flight.erase( key );
+      };
+      try {
+         auto r = f();
+         done();
+         promise.set_value( r );
+         return r;
+      }
+      catch( ... ) {
+         done();
+         promise.set_exception( std::current_exception() );
+         throw;
+      }
+   }
+
+}  // namespace tao::pq::internal
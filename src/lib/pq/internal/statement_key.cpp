@@ -0,0 +1,47 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstring>
+
+#include <tao/pq/internal/statement_key.hpp>
+
+namespace tao::pq::internal
+{
+   namespace
+   {
+      template< typename T >
+      void append( std::string& key, const T& value )
+      {
+         key.append( reinterpret_cast< const char* >( &value ), sizeof( value ) );
+      }
+
+   }  // namespace
+
+   auto statement_key( const char* statement,
+                       const int n_params,
+                       const Oid types[],
+                       const char* const values[],
+                       const int lengths[],
+                       const int formats[] ) -> std::string
+   {
+      const std::size_t size = std::strlen( statement );
+      std::string key;
+      append( key, size );
+      key.append( statement, size );
+      for( int i = 0; i < n_params; ++i ) {
+         append( key, types[ i ] );
+         append( key, formats[ i ] );
+         if( values[ i ] == nullptr ) {
+            append( key, static_cast< std::size_t >( -1 ) );
+         }
+         else {
+            const auto length = ( formats[ i ] == 0 ) ? std::strlen( values[ i ] ) : static_cast< std::size_t >( lengths[ i ] );
+            append( key, length );
+            key.append( values[ i ], length );
+         }
+      }
+      return key;
+   }
+
+}  // namespace tao::pq::internal
@@ -0,0 +1,68 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+
+#if !defined( _WIN32 )
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <tao/pq/internal/poll.hpp>
+#include <tao/pq/internal/wakeup.hpp>
+
+namespace tao::pq::internal
+{
+#if defined( _WIN32 )
+
+   wakeup::wakeup()
+      : m_fds{ -1, -1 }
+   {}
+
+   wakeup::~wakeup() = default;
+
+   void wakeup::notify() noexcept {}
+   void wakeup::clear() noexcept {}
+
+#else
+
+   wakeup::wakeup()
+      : m_fds{ -1, -1 }
+   {
+      if( ::pipe( m_fds ) != 0 ) {
+         // LCOV_EXCL_START
+         const int e = errno;
+         throw std::runtime_error( "pipe() failed: " + internal::errno_to_string( e ) );
+         // LCOV_EXCL_STOP
+      }
+      for( const int fd : m_fds ) {
+         (void)::fcntl( fd, F_SETFL, ::fcntl( fd, F_GETFL ) | O_NONBLOCK );
+         (void)::fcntl( fd, F_SETFD, FD_CLOEXEC );
+      }
+   }
+
+   wakeup::~wakeup()
+   {
+      ::close( m_fds[ 0 ] );
+      ::close( m_fds[ 1 ] );
+   }
+
+   void wakeup::notify() noexcept
+   {
+      const char c = 0;
+      (void)::write( m_fds[ 1 ], &c, 1 );
+   }
+
+   void wakeup::clear() noexcept
+   {
+      char buffer[ 64 ];
+      while( ::read( m_fds[ 0 ], buffer, sizeof( buffer ) ) > 0 ) {
+      }
+   }
+
+#endif
+
+}  // namespace tao::pq::internal
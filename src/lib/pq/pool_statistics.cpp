@@ -0,0 +1,104 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/pool_statistics.hpp>
+
+#include <tao/pq/internal/printf.hpp>
+
+namespace tao::pq
+{
+   namespace
+   {
+      [[nodiscard]] auto seconds( const std::chrono::microseconds us ) noexcept -> double
+      {
+         return std::chrono::duration< double >( us ).count();
+      }
+
+      class exposition final
+      {
+      private:
+         std::string& m_out;
+         const std::string_view m_name;
+         const std::string_view m_labels;
+
+         void sample( const std::string_view suffix, const std::string_view label, const std::string& value )
+         {
+            m_out += m_name;
+            m_out += suffix;
+            if( !m_labels.empty() || !label.empty() ) {
+               m_out += '{';
+               m_out += m_labels;
+               if( !m_labels.empty() && !label.empty() ) {
+                  m_out += ',';
+               }
+               m_out += label;
+               m_out += '}';
+            }
+            m_out += ' ';
+            m_out += value;
+            m_out += '\n';
+         }
+
+      public:
+         exposition( std::string& out, const std::string_view name, const std::string_view labels ) noexcept
+            : m_out( out ),
+              m_name( name ),
+              m_labels( labels )
+         {}
+
+         void type( const std::string_view suffix, const char* type )
+         {
+            m_out += "# TYPE ";
+            m_out += m_name;
+            m_out += suffix;
+            m_out += ' ';
+            m_out += type;
+            m_out += '\n';
+         }
+
+         void gauge( const std::string_view suffix, const std::string_view label, const std::size_t value )
+         {
+            sample( suffix, label, std::to_string( value ) );
+         }
+
+         void counter( const std::string_view suffix, const std::size_t value )
+         {
+            type( suffix, "counter" );
+            sample( suffix, "", std::to_string( value ) );
+         }
+
+         void histogram( const std::string& suffix, const latency_histogram& h )
+         {
+            type( suffix, "histogram" );
+            std::size_t cumulative = 0;
+            for( std::size_t i = 0; i < h.counts.size(); ++i ) {
+               cumulative += h.counts[ i ];
+               const auto le = ( i < h.bounds.size() ) ? internal::printf( "le=\"%.9g\"", seconds( h.bounds[ i ] ) ) : std::string( "le=\"+Inf\"" );
+               sample( suffix + "_bucket", le, std::to_string( cumulative ) );
+            }
+            sample( suffix + "_sum", "", internal::printf( "%.9g", seconds( h.sum ) ) );
+            sample( suffix + "_count", "", std::to_string( h.count ) );
+         }
+      };
+
+   }  // namespace
+
+   auto to_prometheus( const pool_statistics& s, const std::string_view name, const std::string_view labels ) -> std::string
+   {
+      std::string result;
+      exposition e( result, name, labels );
+      e.type( "_connections", "gauge" );
+      e.gauge( "_connections", "state=\"idle\"", s.idle );
+      e.gauge( "_connections", "state=\"in_use\"", s.in_use );
+      e.counter( "_connections_created_total", s.created );
+      e.counter( "_connections_destroyed_total", s.destroyed );
+      e.counter( "_connections_invalidated_total", s.invalidated );
+      e.type( "_result_memory_bytes", "gauge" );
+      e.gauge( "_result_memory_bytes", "", s.result_memory );
+      e.histogram( "_checkout_seconds", s.checkout_latency );
+      e.histogram( "_hold_seconds", s.hold_time );
+      return result;
+   }
+
+}  // namespace tao::pq
@@ -9,11 +9,30 @@
 #include <tao/pq/result.hpp>
 
 #include <tao/pq/internal/from_chars.hpp>
+#include <tao/pq/internal/gauge.hpp>
 #include <tao/pq/internal/printf.hpp>
 #include <tao/pq/internal/unreachable.hpp>
 
 namespace tao::pq
 {
+   namespace
+   {
+      [[nodiscard]] auto make_pgresult( PGresult* pgresult, const std::shared_ptr< internal::gauge >& gauge ) -> std::shared_ptr< PGresult >
+      {
+         if( !gauge ) {
+            return std::shared_ptr< PGresult >( pgresult, &PQclear );
+         }
+         const std::size_t size = PQresultMemorySize( pgresult );
+         gauge->add( size );
+         // the deleter is also called when allocating the control block fails
+         return std::shared_ptr< PGresult >( pgresult, [ gauge, size ]( PGresult* p ) {
+            gauge->sub( size );
+            PQclear( p );
+         } );
+      }
+
+   }  // namespace
+
    void result::check_has_result_set() const
    {
       if( m_columns == 0 ) {
@@ -32,8 +51,8 @@ namespace tao::pq
       }
    }
 
-   result::result( PGresult* pgresult )
-      : m_pgresult( pgresult, &PQclear ),
+   result::result( PGresult* pgresult, const std::shared_ptr< internal::gauge >& gauge )
+      : m_pgresult( make_pgresult( pgresult, gauge ) ),
         m_columns( PQnfields( pgresult ) ),
         m_rows( PQntuples( pgresult ) )
    {
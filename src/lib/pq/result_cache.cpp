@@ -0,0 +1,190 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/result_cache.hpp>
+
+#include <libpq-fe.h>
+
+namespace tao::pq
+{
+   result_cache::result_cache( const private_key /*unused*/, const std::shared_ptr< connection_pool >& pool, const std::chrono::milliseconds ttl, const std::size_t max_memory )  // NOLINT(modernize-pass-by-value)
+      : m_pool( pool ),
+        m_ttl( ttl ),
+        m_max_memory( max_memory ),
+        m_epoch( 0 ),
+        m_memory( 0 ),
+        m_hits( 0 ),
+        m_misses( 0 )
+   {}
+
+   auto result_cache::create( const std::shared_ptr< connection_pool >& pool, const std::chrono::milliseconds ttl, const std::size_t max_memory ) -> std::shared_ptr< result_cache >
+   {
+      return std::make_shared< result_cache >( private_key(), pool, ttl, max_memory );
+   }
+
+   void result_cache::erase( const std::unordered_map< std::string, entry >::iterator it ) noexcept
+   {
+      for( const auto& name : it->second.channels ) {
+         const auto jt = m_channels.find( name );
+         if( jt != m_channels.end() ) {
+            jt->second.keys.erase( &it->first );
+         }
+      }
+      m_lru.erase( it->second.lru );
+      m_memory -= it->second.size;
+      m_entries.erase( it );
+   }
+
+   void result_cache::listen( const std::vector< std::string >& channels )
+   {
+      const std::lock_guard lock( m_listener_mutex );
+      if( !m_listener ) {
+         // a dedicated connection which is not returned to the pool
+         m_listener = m_pool->connection();
+         connection_pool::detach( m_listener );
+      }
+      for( const auto& name : channels ) {
+         if( m_listening.find( name ) == m_listening.end() ) {
+            m_listener->listen( name, [ this, name ]( const char* /*unused*/ ) { result_cache::invalidate( name ); } );
+            m_listening.emplace( name );
+         }
+      }
+   }
+
+   void result_cache::drain_notifications() noexcept
+   {
+      if( m_listener ) {
+         try {
+            m_listener->get_notifications();
+         }
+         catch( ... ) {
+            // without a working listener, notifications might have been lost
+            m_listener.reset();
+            m_listening.clear();
+            result_cache::clear();
+         }
+      }
+   }
+
+   void result_cache::poll_notifications() noexcept
+   {
+      // wait for another thread that is processing the notifications, otherwise this
+      // lookup could miss an invalidation which has already arrived and return a stale entry
+      const std::lock_guard lock( m_listener_mutex );
+      result_cache::drain_notifications();
+   }
+
+   void result_cache::handle_notifications()
+   {
+      result_cache::poll_notifications();
+   }
+
+   auto result_cache::lookup( const std::vector< std::string >& channels, std::string&& key, const std::function< result() >& f ) -> result
+   {
+      result_cache::poll_notifications();
+      {
+         const std::lock_guard lock( m_mutex );
+         const auto it = m_entries.find( key );
+         if( it != m_entries.end() ) {
+            if( it->second.expires > std::chrono::steady_clock::now() ) {
+               m_hits.fetch_add( 1, std::memory_order_relaxed );
+               m_lru.splice( m_lru.begin(), m_lru, it->second.lru );
+               return it->second.result;
+            }
+            result_cache::erase( it );
+         }
+      }
+      m_misses.fetch_add( 1, std::memory_order_relaxed );
+
+      // start listening before executing the statement, and remember
+      // the generations to detect notifications which arrive meanwhile
+      if( !channels.empty() ) {
+         result_cache::listen( channels );
+      }
+      std::vector< std::uint64_t > generations;
+      std::uint64_t epoch;
+      {
+         const std::lock_guard lock( m_mutex );
+         epoch = m_epoch;
+         for( const auto& name : channels ) {
+            generations.push_back( m_channels[ name ].generation );
+         }
+      }
+
+      auto r = f();
+      result_cache::poll_notifications();
+
+      const auto size = PQresultMemorySize( r.underlying_raw_ptr() ) + key.size() + sizeof( entry );
+      if( size > m_max_memory ) {
+         return r;
+      }
+
+      const std::lock_guard lock( m_mutex );
+      if( epoch != m_epoch ) {
+         return r;
+      }
+      for( std::size_t i = 0; i < channels.size(); ++i ) {
+         if( m_channels[ channels[ i ] ].generation != generations[ i ] ) {
+            return r;
+         }
+      }
+      const auto [ it, inserted ] = m_entries.try_emplace( std::move( key ), r, std::chrono::steady_clock::now() + m_ttl, size, channels );
+      if( inserted ) {
+         m_lru.push_front( &it->first );
+         it->second.lru = m_lru.begin();
+         for( const auto& name : channels ) {
+            m_channels[ name ].keys.insert( &it->first );
+         }
+         m_memory += size;
+         while( m_memory > m_max_memory ) {
+            result_cache::erase( m_entries.find( *m_lru.back() ) );
+         }
+      }
+      return r;
+   }
+
+   void result_cache::invalidate( const std::string_view channel )
+   {
+      const std::lock_guard lock( m_mutex );
+      const auto it = m_channels.find( channel );
+      if( it != m_channels.end() ) {
+         ++it->second.generation;
+         while( !it->second.keys.empty() ) {
+            result_cache::erase( m_entries.find( **it->second.keys.begin() ) );
+         }
+      }
+   }
+
+   void result_cache::clear() noexcept
+   {
+      const std::lock_guard lock( m_mutex );
+      ++m_epoch;
+      m_entries.clear();
+      m_lru.clear();
+      for( auto& [ name, c ] : m_channels ) {
+         c.keys.clear();
+      }
+      m_memory = 0;
+   }
+
+   auto result_cache::hit_rate() const noexcept -> double
+   {
+      const auto h = hits();
+      const auto total = h + misses();
+      return ( total == 0 ) ? 0.0 : ( static_cast< double >( h ) / static_cast< double >( total ) );
+   }
+
+   auto result_cache::size() const -> std::size_t
+   {
+      const std::lock_guard lock( m_mutex );
+      return m_entries.size();
+   }
+
+   auto result_cache::memory_usage() const -> std::size_t
+   {
+      const std::lock_guard lock( m_mutex );
+      return m_memory;
+   }
+
+}  // namespace tao::pq
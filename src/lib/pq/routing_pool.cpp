@@ -0,0 +1,238 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/routing_pool.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include <tao/pq/exception.hpp>
+
+namespace tao::pq
+{
+   namespace
+   {
+      // a replica which failed is not used for this long
+      constexpr std::chrono::milliseconds down_time( 1000 );
+
+      // polling interval while waiting for a replica to replay an LSN
+      constexpr std::chrono::microseconds min_backoff( 100 );
+      constexpr std::chrono::microseconds max_backoff( 10000 );
+
+      [[nodiscard]] auto ticks( const std::chrono::steady_clock::time_point tp ) noexcept -> std::int64_t
+      {
+         return std::chrono::duration_cast< std::chrono::microseconds >( tp.time_since_epoch() ).count();
+      }
+
+      // on a primary, pg_last_wal_replay_lsn() is NULL and the current position is used instead
+      [[nodiscard]] auto wait_for_lsn( pq::connection& c, const std::string_view lsn, const std::chrono::steady_clock::time_point end ) -> bool
+      {
+         auto backoff = min_backoff;
+         while( true ) {
+            if( c.execute( "SELECT COALESCE( pg_last_wal_replay_lsn(), pg_current_wal_lsn() ) >= $1::pg_lsn", lsn ).as< bool >() ) {
+               return true;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if( now >= end ) {
+               return false;
+            }
+            std::this_thread::sleep_for( std::min< std::chrono::steady_clock::duration >( backoff, end - now ) );
+            backoff = std::min( backoff * 2, max_backoff );
+         }
+      }
+
+   }  // namespace
+
+   struct routing_pool::node final
+   {
+      const std::shared_ptr< connection_pool > pool;
+      std::atomic< std::int64_t > latency;     // in microseconds
+      std::atomic< std::int64_t > down_until;  // in microseconds since the epoch of the steady clock
+
+      explicit node( const std::shared_ptr< connection_pool >& p )  // NOLINT(modernize-pass-by-value)
+         : pool( p ),
+           latency( 0 ),
+           down_until( 0 )
+      {}
+
+      [[nodiscard]] auto is_up( const std::int64_t now ) const noexcept -> bool
+      {
+         return down_until.load( std::memory_order_relaxed ) <= now;
+      }
+
+      void mark_down() noexcept
+      {
+         down_until.store( ticks( std::chrono::steady_clock::now() + down_time ), std::memory_order_relaxed );
+      }
+
+      // exponentially weighted moving average, concurrent updates may
+      // occasionally lose a sample, which is irrelevant for an estimate
+      void record( const std::chrono::steady_clock::duration d ) noexcept
+      {
+         const auto sample = std::chrono::duration_cast< std::chrono::microseconds >( d ).count();
+         const auto current = latency.load( std::memory_order_relaxed );
+         latency.store( ( current == 0 ) ? sample : ( current + ( sample - current ) / 8 ), std::memory_order_relaxed );
+      }
+   };
+
+   routing_pool::routing_pool( const private_key /*unused*/, const std::shared_ptr< connection_pool >& primary, const std::vector< std::shared_ptr< connection_pool > >& replicas )  // NOLINT(modernize-pass-by-value)
+      : m_primary( primary ),
+        m_replay_timeout( std::chrono::milliseconds( 1000 ) )
+   {
+      m_replicas.reserve( replicas.size() );
+      for( const auto& pool : replicas ) {
+         m_replicas.emplace_back( std::make_unique< node >( pool ) );
+      }
+   }
+
+   routing_pool::~routing_pool() = default;
+
+   auto routing_pool::create( const std::shared_ptr< connection_pool >& primary, const std::vector< std::shared_ptr< connection_pool > >& replicas ) -> std::shared_ptr< routing_pool >
+   {
+      return std::make_shared< routing_pool >( private_key(), primary, replicas );
+   }
+
+   auto routing_pool::create( const std::string_view primary_info, const std::vector< std::string >& replica_infos ) -> std::shared_ptr< routing_pool >
+   {
+      std::vector< std::shared_ptr< connection_pool > > replicas;
+      replicas.reserve( replica_infos.size() );
+      for( const auto& info : replica_infos ) {
+         replicas.emplace_back( connection_pool::create( info ) );
+      }
+      return routing_pool::create( connection_pool::create( primary_info ), replicas );
+   }
+
+   auto routing_pool::replica( const std::size_t index ) const -> const std::shared_ptr< connection_pool >&
+   {
+      if( index >= m_replicas.size() ) {
+         throw std::out_of_range( "invalid replica index" );
+      }
+      return m_replicas[ index ]->pool;
+   }
+
+   auto routing_pool::replica_latency( const std::size_t index ) const -> std::chrono::microseconds
+   {
+      if( index >= m_replicas.size() ) {
+         throw std::out_of_range( "invalid replica index" );
+      }
+      return std::chrono::microseconds( m_replicas[ index ]->latency.load( std::memory_order_relaxed ) );
+   }
+
+   void routing_pool::set_replay_timeout( const std::chrono::milliseconds timeout ) noexcept
+   {
+      m_replay_timeout.store( timeout, std::memory_order_relaxed );
+   }
+
+   auto routing_pool::replica_connection( const std::optional< std::string_view >& min_lsn ) -> std::pair< std::shared_ptr< pq::connection >, node* >
+   {
+      const auto start = std::chrono::steady_clock::now();
+      const auto end = start + replay_timeout();
+
+      std::vector< node* > candidates;
+      for( const auto& r : m_replicas ) {
+         if( r->is_up( ticks( start ) ) ) {
+            candidates.push_back( r.get() );
+         }
+      }
+
+      thread_local std::minstd_rand rng( std::random_device{}() );
+      while( !candidates.empty() ) {
+         // power of two choices: pick two random candidates, use the faster one
+         auto it = candidates.begin();
+         if( candidates.size() > 1 ) {
+            std::uniform_int_distribution< std::size_t > dist( 0, candidates.size() - 1 );
+            const auto i = dist( rng );
+            auto j = dist( rng );
+            while( j == i ) {
+               j = dist( rng );
+            }
+            it += static_cast< std::ptrdiff_t >( ( candidates[ j ]->latency.load( std::memory_order_relaxed ) < candidates[ i ]->latency.load( std::memory_order_relaxed ) ) ? j : i );
+         }
+         auto* r = *it;
+         try {
+            const auto before = std::chrono::steady_clock::now();
+            auto c = r->pool->connection();
+            if( !min_lsn ) {
+               return { std::move( c ), r };
+            }
+            if( wait_for_lsn( *c, *min_lsn, end ) ) {
+               r->record( std::chrono::steady_clock::now() - before );
+               return { std::move( c ), r };
+            }
+            // the replicas are lagging, reading from the primary is faster than waiting any longer
+            break;
+         }
+         catch( const connection_error& /*unused*/ ) {
+            r->mark_down();
+         }
+         catch( const timeout_reached& /*unused*/ ) {
+            r->mark_down();
+         }
+         candidates.erase( it );
+      }
+      return { m_primary->connection(), nullptr };
+   }
+
+   auto routing_pool::read_only_transaction( const isolation_level il, const std::optional< std::string_view >& min_lsn ) -> std::shared_ptr< pq::transaction >
+   {
+      while( true ) {
+         const auto [ c, r ] = routing_pool::replica_connection( min_lsn );
+         if( r == nullptr ) {
+            return c->transaction( access_mode::read_only, il );
+         }
+         try {
+            const auto before = std::chrono::steady_clock::now();
+            auto tr = c->transaction( access_mode::read_only, il );
+            r->record( std::chrono::steady_clock::now() - before );
+            return tr;
+         }
+         catch( const connection_error& /*unused*/ ) {
+            r->mark_down();
+         }
+         catch( const timeout_reached& /*unused*/ ) {
+            r->mark_down();
+         }
+      }
+   }
+
+   auto routing_pool::connection( const access_mode am ) -> std::shared_ptr< pq::connection >
+   {
+      if( am == access_mode::read_only ) {
+         return routing_pool::replica_connection( std::nullopt ).first;
+      }
+      return m_primary->connection();
+   }
+
+   auto routing_pool::connection( const std::string_view min_lsn ) -> std::shared_ptr< pq::connection >
+   {
+      return routing_pool::replica_connection( min_lsn ).first;
+   }
+
+   auto routing_pool::transaction( const access_mode am, const isolation_level il ) -> std::shared_ptr< pq::transaction >
+   {
+      if( am == access_mode::read_only ) {
+         return routing_pool::read_only_transaction( il, std::nullopt );
+      }
+      return m_primary->connection()->transaction( am, il );
+   }
+
+   auto routing_pool::transaction( const isolation_level il, const access_mode am ) -> std::shared_ptr< pq::transaction >
+   {
+      return routing_pool::transaction( am, il );
+   }
+
+   auto routing_pool::transaction( const std::string_view min_lsn, const isolation_level il ) -> std::shared_ptr< pq::transaction >
+   {
+      return routing_pool::read_only_transaction( il, min_lsn );
+   }
+
+   auto routing_pool::primary_lsn() -> std::string
+   {
+      return m_primary->execute( "SELECT pg_current_wal_lsn()::TEXT" ).as< std::string >();
+   }
+
+}  // namespace tao::pq
@@ -0,0 +1,165 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/scatter_gather.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/internal/async.hpp>
+#include <tao/pq/internal/poll.hpp>
+
+namespace tao::pq
+{
+   namespace
+   {
+      struct pending final
+      {
+         std::size_t index;
+         std::chrono::steady_clock::time_point start;
+         std::shared_ptr< pq::connection > connection;
+         std::unique_ptr< internal::result_operation > operation;
+         std::optional< internal::poll_status > ready = internal::poll_status::again;
+      };
+
+      [[nodiscard]] auto elapsed( const std::chrono::steady_clock::time_point start ) noexcept -> std::chrono::microseconds
+      {
+         return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - start );
+      }
+
+   }  // namespace
+
+   scatter_gather::scatter_gather( const private_key /*unused*/, const std::vector< std::shared_ptr< connection_pool > >& pools )  // NOLINT(modernize-pass-by-value)
+      : m_pools( pools )
+   {
+      if( m_pools.empty() ) {
+         throw std::invalid_argument( "no connection pools" );
+      }
+   }
+
+   auto scatter_gather::create( const std::vector< std::shared_ptr< connection_pool > >& pools ) -> std::shared_ptr< scatter_gather >
+   {
+      return std::make_shared< scatter_gather >( private_key(), pools );
+   }
+
+   void scatter_gather::set_timeout( const std::chrono::milliseconds timeout )
+   {
+      m_timeout = timeout;
+   }
+
+   void scatter_gather::reset_timeout() noexcept
+   {
+      m_timeout = std::nullopt;
+   }
+
+   void scatter_gather::run( const std::vector< job >& jobs, const std::function< void( std::size_t, target_result&& ) >& f ) const
+   {
+      // all statements are sent before waiting for any result,
+      // so the total latency is that of the slowest target
+      std::vector< std::unique_ptr< pending > > active;
+      active.reserve( jobs.size() );
+      for( std::size_t i = 0; i < jobs.size(); ++i ) {
+         const auto start = std::chrono::steady_clock::now();
+         try {
+            auto p = std::make_unique< pending >();
+            p->index = i;
+            p->start = start;
+            p->connection = jobs[ i ].first->connection();
+            if( m_timeout ) {
+               p->connection->set_timeout( *m_timeout );
+            }
+            const auto tr = p->connection->direct();
+            jobs[ i ].second( *tr );
+            p->operation = std::make_unique< internal::result_operation >( tr, start );
+            active.emplace_back( std::move( p ) );
+         }
+         catch( ... ) {
+            f( i, { std::nullopt, std::current_exception(), elapsed( start ) } );
+         }
+      }
+
+      std::vector< internal::poll_item > items;
+      while( !active.empty() ) {
+         auto it = active.begin();
+         while( it != active.end() ) {
+            auto& p = **it;
+            if( !p.ready ) {
+               ++it;
+               continue;
+            }
+            // only the operation itself is guarded, exceptions thrown by f are passed on to the caller
+            target_result r;
+            try {
+               if( !p.operation->resume( *p.ready ) ) {
+                  p.ready = std::nullopt;
+                  ++it;
+                  continue;
+               }
+               r.result.emplace( p.operation->get() );
+            }
+            catch( ... ) {
+               r.error = std::current_exception();
+            }
+            const auto done = std::move( *it );
+            it = active.erase( it );
+            r.latency = elapsed( done->start );
+            f( done->index, std::move( r ) );
+         }
+         if( active.empty() ) {
+            break;
+         }
+
+         std::optional< std::chrono::steady_clock::time_point > end;
+         items.clear();
+         for( const auto& p : active ) {
+            items.push_back( { p->operation->socket(), p->operation->wait_for_write(), internal::poll_status::timeout } );
+            if( const auto& e = p->operation->end() ) {
+               end = end ? std::min( *end, *e ) : *e;
+            }
+         }
+         std::ignore = internal::poll( items, end ? internal::poll_timeout( *end ) : -1 );
+
+         const auto now = std::chrono::steady_clock::now();
+         auto item = items.begin();
+         for( const auto& p : active ) {
+            if( item->status != internal::poll_status::timeout ) {
+               p->ready = item->status;
+            }
+            else if( const auto& e = p->operation->end(); e && ( now >= *e ) ) {
+               p->ready = internal::poll_status::timeout;
+            }
+            ++item;
+         }
+      }
+   }
+
+   auto scatter_gather::gather( const std::vector< job >& jobs ) const -> std::vector< target_result >
+   {
+      // pq::result is not assignable, the results arrive in any order and are collected in slots first
+      std::vector< std::optional< target_result > > slots( jobs.size() );
+      scatter_gather::run( jobs, [ & ]( const std::size_t index, target_result&& r ) { slots[ index ].emplace( std::move( r ) ); } );
+      std::vector< target_result > results;
+      results.reserve( slots.size() );
+      for( auto& slot : slots ) {
+         results.emplace_back( std::move( *slot ) );
+      }
+      return results;
+   }
+
+   auto scatter_gather::failures( const std::vector< target_result >& results ) noexcept -> std::size_t
+   {
+      return static_cast< std::size_t >( std::count_if( results.begin(), results.end(), []( const target_result& r ) { return !r; } ) );
+   }
+
+   void scatter_gather::check( const std::vector< target_result >& results )
+   {
+      for( const auto& r : results ) {
+         if( r.error ) {
+            std::rethrow_exception( r.error );
+         }
+      }
+   }
+
+}  // namespace tao::pq
@@ -0,0 +1,208 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/sharded_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+namespace tao::pq
+{
+   namespace
+   {
+      // FNV-1a with a final avalanche step, stable across processes and platforms,
+      // so that all services map a key to the same shard
+      [[nodiscard]] auto hash( const std::string_view data ) noexcept -> std::uint64_t
+      {
+         std::uint64_t h = 0xcbf29ce484222325;
+         for( const char c : data ) {
+            h ^= static_cast< unsigned char >( c );
+            h *= 0x100000001b3;
+         }
+         h ^= h >> 30;
+         h *= 0xbf58476d1ce4e5b9;
+         h ^= h >> 27;
+         h *= 0x94d049bb133111eb;
+         h ^= h >> 31;
+         return h;
+      }
+
+   }  // namespace
+
+   struct sharded_pool::shard final
+   {
+      const std::string name;
+      const std::shared_ptr< connection_pool > pool;
+      std::atomic< std::size_t > requests;
+
+      shard( const std::string& n, const std::shared_ptr< connection_pool >& p )  // NOLINT(modernize-pass-by-value)
+         : name( n ),
+           pool( p ),
+           requests( 0 )
+      {}
+   };
+
+   struct sharded_pool::ring final
+   {
+      std::vector< std::shared_ptr< shard > > shards;                // ordered by name
+      std::vector< std::pair< std::uint64_t, std::size_t > > points;  // ordered by hash
+   };
+
+   sharded_pool::sharded_pool( const private_key /*unused*/, const std::size_t virtual_nodes )
+      : m_virtual_nodes( virtual_nodes ),
+        m_ring( std::make_shared< const ring >() )
+   {
+      if( virtual_nodes == 0 ) {
+         throw std::invalid_argument( "invalid number of virtual nodes" );
+      }
+   }
+
+   sharded_pool::~sharded_pool() = default;
+
+   auto sharded_pool::create( const std::size_t virtual_nodes ) -> std::shared_ptr< sharded_pool >
+   {
+      return std::make_shared< sharded_pool >( private_key(), virtual_nodes );
+   }
+
+   auto sharded_pool::snapshot() const -> std::shared_ptr< const ring >
+   {
+      const std::lock_guard lock( m_mutex );
+      return m_ring;
+   }
+
+   // must be called with m_mutex locked
+   void sharded_pool::update( std::map< std::string, std::shared_ptr< connection_pool >, std::less<> >&& pools )
+   {
+      auto next = std::make_shared< ring >();
+      next->shards.reserve( pools.size() );
+      next->points.reserve( pools.size() * m_virtual_nodes );
+      for( auto& [ name, pool ] : pools ) {
+         if( !pool ) {
+            throw std::invalid_argument( "invalid connection pool for shard " + name );
+         }
+
+         // shards which keep their pool also keep their statistics
+         const auto it = std::find_if( m_ring->shards.begin(), m_ring->shards.end(), [ & ]( const auto& s ) { return s->name == name; } );
+         if( ( it != m_ring->shards.end() ) && ( ( *it )->pool == pool ) ) {
+            next->shards.emplace_back( *it );
+         }
+         else {
+            next->shards.emplace_back( std::make_shared< shard >( name, pool ) );
+         }
+
+         const auto index = next->shards.size() - 1;
+         for( std::size_t i = 0; i < m_virtual_nodes; ++i ) {
+            next->points.emplace_back( hash( name + '#' + std::to_string( i ) ), index );
+         }
+      }
+      std::sort( next->points.begin(), next->points.end() );
+      m_ring = std::move( next );
+   }
+
+   void sharded_pool::add_shard( const std::string_view name, const std::shared_ptr< connection_pool >& pool )
+   {
+      const std::lock_guard lock( m_mutex );
+      std::map< std::string, std::shared_ptr< connection_pool >, std::less<> > pools;
+      for( const auto& s : m_ring->shards ) {
+         pools.emplace( s->name, s->pool );
+      }
+      if( !pools.emplace( name, pool ).second ) {
+         throw std::invalid_argument( "duplicate shard " + std::string( name ) );
+      }
+      sharded_pool::update( std::move( pools ) );
+   }
+
+   void sharded_pool::add_shard( const std::string_view name, const std::string_view connection_info )
+   {
+      sharded_pool::add_shard( name, connection_pool::create( connection_info ) );
+   }
+
+   void sharded_pool::remove_shard( const std::string_view name )
+   {
+      const std::lock_guard lock( m_mutex );
+      std::map< std::string, std::shared_ptr< connection_pool >, std::less<> > pools;
+      for( const auto& s : m_ring->shards ) {
+         pools.emplace( s->name, s->pool );
+      }
+      if( pools.erase( std::string( name ) ) == 0 ) {
+         throw std::invalid_argument( "unknown shard " + std::string( name ) );
+      }
+      sharded_pool::update( std::move( pools ) );
+   }
+
+   void sharded_pool::rebalance( const std::map< std::string, std::shared_ptr< connection_pool >, std::less<> >& pools )
+   {
+      auto copy = pools;
+      const std::lock_guard lock( m_mutex );
+      sharded_pool::update( std::move( copy ) );
+   }
+
+   auto sharded_pool::shards() const -> std::vector< std::string >
+   {
+      const auto r = sharded_pool::snapshot();
+      std::vector< std::string > result;
+      result.reserve( r->shards.size() );
+      for( const auto& s : r->shards ) {
+         result.emplace_back( s->name );
+      }
+      return result;
+   }
+
+   auto sharded_pool::find( const std::string_view key ) const -> std::shared_ptr< shard >
+   {
+      const auto r = sharded_pool::snapshot();
+      if( r->points.empty() ) {
+         throw std::logic_error( "no shards available" );
+      }
+
+      // the first virtual node clockwise from the key's position on the ring
+      const auto h = hash( key );
+      auto it = std::lower_bound( r->points.begin(), r->points.end(), h, []( const auto& p, const std::uint64_t v ) { return p.first < v; } );
+      if( it == r->points.end() ) {
+         it = r->points.begin();
+      }
+      return r->shards[ it->second ];
+   }
+
+   auto sharded_pool::shard_name( const std::string_view key ) const -> std::string
+   {
+      return sharded_pool::find( key )->name;
+   }
+
+   auto sharded_pool::pool( const std::string_view key ) const -> std::shared_ptr< connection_pool >
+   {
+      const auto s = sharded_pool::find( key );
+      s->requests.fetch_add( 1, std::memory_order_relaxed );
+      return s->pool;
+   }
+
+   auto sharded_pool::connection( const std::string_view key ) -> std::shared_ptr< pq::connection >
+   {
+      return sharded_pool::pool( key )->connection();
+   }
+
+   auto sharded_pool::transaction( const std::string_view key, const access_mode am, const isolation_level il ) -> std::shared_ptr< pq::transaction >
+   {
+      return sharded_pool::connection( key )->transaction( am, il );
+   }
+
+   auto sharded_pool::transaction( const std::string_view key, const isolation_level il, const access_mode am ) -> std::shared_ptr< pq::transaction >
+   {
+      return sharded_pool::connection( key )->transaction( am, il );
+   }
+
+   auto sharded_pool::statistics() const -> std::vector< shard_statistics >
+   {
+      const auto r = sharded_pool::snapshot();
+      std::vector< shard_statistics > result;
+      result.reserve( r->shards.size() );
+      for( const auto& s : r->shards ) {
+         result.push_back( { s->name, s->requests.load( std::memory_order_relaxed ), s->pool->size(), m_virtual_nodes } );
+      }
+      return result;
+   }
+
+}  // namespace tao::pq
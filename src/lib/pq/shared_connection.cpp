@@ -0,0 +1,328 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/shared_connection.hpp>
+
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#include <libpq-fe.h>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/deadline.hpp>
+#include <tao/pq/exception.hpp>
+#include <tao/pq/internal/poll.hpp>
+#include <tao/pq/internal/wakeup.hpp>
+
+namespace tao::pq
+{
+   namespace
+   {
+      // how often the driver checks the queue where it can not be woken up, in milliseconds
+      constexpr int tick = 10;
+
+   }  // namespace
+
+   struct shared_connection::request final
+   {
+      request* next = nullptr;
+
+      const std::string statement;
+      std::vector< Oid > types;
+      std::string buffer;
+      std::vector< std::ptrdiff_t > offsets;  // -1 for NULL
+      std::vector< int > lengths;
+      std::vector< int > formats;
+
+      std::promise< result > promise;
+
+      request( const char* s,
+               const int n_params,
+               const Oid t[],
+               const char* const v[],
+               const int l[],
+               const int f[] )
+         : statement( s )
+      {
+         if( n_params != 0 ) {
+            types.assign( t, t + n_params );
+            lengths.assign( l, l + n_params );
+            formats.assign( f, f + n_params );
+            offsets.reserve( n_params );
+            for( int i = 0; i < n_params; ++i ) {
+               if( v[ i ] == nullptr ) {
+                  offsets.push_back( -1 );
+               }
+               else {
+                  offsets.push_back( static_cast< std::ptrdiff_t >( buffer.size() ) );
+                  // text parameters are NUL-terminated, binary parameters have an explicit length
+                  const auto size = ( f[ i ] == 0 ) ? ( std::strlen( v[ i ] ) + 1 ) : static_cast< std::size_t >( l[ i ] );
+                  buffer.append( v[ i ], size );
+               }
+            }
+         }
+      }
+
+      // each statement is followed by its own sync point, so an
+      // error only affects the statement which caused it
+      [[nodiscard]] auto send( PGconn* pgconn ) const -> bool
+      {
+         std::vector< const char* > values;
+         values.reserve( offsets.size() );
+         for( const auto offset : offsets ) {
+            values.push_back( ( offset < 0 ) ? nullptr : ( buffer.data() + offset ) );
+         }
+         return ( PQsendQueryParams( pgconn, statement.c_str(), static_cast< int >( offsets.size() ), types.data(), values.data(), lengths.data(), formats.data(), 0 ) != 0 ) &&
+                ( PQpipelineSync( pgconn ) != 0 );
+      }
+   };
+
+   shared_connection::shared_connection( const private_key /*unused*/, const std::string& connection_info )
+      : m_connection_info( connection_info ),
+        m_timeout( 0 ),
+        m_connection( open() ),
+        m_wakeup( std::make_unique< internal::wakeup >() ),
+        m_queue( nullptr ),
+        m_waiting( false ),
+        m_polling( false ),
+        m_stopping( false )
+   {
+      m_driver = std::thread( &shared_connection::run, this );
+   }
+
+   shared_connection::~shared_connection()
+   {
+      m_stopping = true;
+      {
+         const std::lock_guard lock( m_mutex );
+         m_condition.notify_one();
+      }
+      m_wakeup->notify();
+      m_driver.join();
+   }
+
+   auto shared_connection::create( const std::string& connection_info ) -> std::shared_ptr< shared_connection >
+   {
+      return std::make_shared< shared_connection >( private_key(), connection_info );
+   }
+
+   auto shared_connection::timeout() const noexcept -> std::optional< std::chrono::milliseconds >
+   {
+      const auto timeout = m_timeout.load( std::memory_order_relaxed );
+      if( timeout == 0 ) {
+         return std::nullopt;
+      }
+      return std::chrono::milliseconds( timeout );
+   }
+
+   void shared_connection::set_timeout( const std::chrono::milliseconds timeout )
+   {
+      if( timeout.count() <= 0 ) {
+         throw std::invalid_argument( "invalid timeout, must be positive" );
+      }
+      m_timeout.store( timeout.count(), std::memory_order_relaxed );
+   }
+
+   void shared_connection::reset_timeout() noexcept
+   {
+      m_timeout.store( 0, std::memory_order_relaxed );
+   }
+
+   auto shared_connection::open() const -> std::shared_ptr< pq::connection >
+   {
+      const auto t = timeout();
+      auto result = t ? pq::connection::create( m_connection_info, pq::deadline::after( *t ) ) : pq::connection::create( m_connection_info );
+      if( PQenterPipelineMode( result->underlying_raw_ptr() ) == 0 ) {
+         throw pq::connection_error( PQerrorMessage( result->underlying_raw_ptr() ) );  // LCOV_EXCL_LINE
+      }
+      return result;
+   }
+
+   auto shared_connection::enqueue( const char* statement,
+                                    const int n_params,
+                                    const Oid types[],
+                                    const char* const values[],
+                                    const int lengths[],
+                                    const int formats[] ) -> std::future< result >
+   {
+      auto* r = new request( statement, n_params, types, values, lengths, formats );
+      auto future = r->promise.get_future();
+
+      // lock-free push, the driver thread takes all queued requests at once
+      r->next = m_queue.load();
+      while( !m_queue.compare_exchange_weak( r->next, r ) ) {
+      }
+
+      // the driver announces that it is about to sleep before it checks the queue
+      // one last time, so either it sees the new request or we see it waiting
+      if( m_waiting ) {
+         const std::lock_guard lock( m_mutex );
+         m_condition.notify_one();
+      }
+      else if( m_polling.exchange( false ) ) {
+         m_wakeup->notify();
+      }
+      return future;
+   }
+
+   auto shared_connection::dequeue() noexcept -> request*
+   {
+      // the queue is a stack, reverse it to send the statements in order
+      request* result = nullptr;
+      request* r = m_queue.exchange( nullptr );
+      while( r != nullptr ) {
+         auto* next = r->next;
+         r->next = result;
+         result = r;
+         r = next;
+      }
+      return result;
+   }
+
+   void shared_connection::run() noexcept
+   {
+      std::deque< std::unique_ptr< request > > in_flight;
+      std::unique_ptr< PGresult, decltype( &PQclear ) > last( nullptr, &PQclear );
+      bool flushed = true;
+      auto progress = std::chrono::steady_clock::now();  // when the last result arrived
+      while( true ) {
+         try {
+            // everything queued since the last round trip is sent as one batch
+            auto* r = dequeue();
+            if( ( r != nullptr ) && !m_connection ) {
+               // the connection broke before, the batch fails fast if it can not be replaced
+               try {
+                  m_connection = open();
+               }
+               catch( ... ) {
+                  const auto e = std::current_exception();
+                  while( r != nullptr ) {
+                     const std::unique_ptr< request > current( r );
+                     r = current->next;
+                     current->promise.set_exception( e );
+                  }
+               }
+            }
+            if( r != nullptr ) {
+               PGconn* pgconn = m_connection->underlying_raw_ptr();
+               if( in_flight.empty() ) {
+                  progress = std::chrono::steady_clock::now();
+               }
+               while( r != nullptr ) {
+                  std::unique_ptr< request > current( r );
+                  r = current->next;
+                  if( current->send( pgconn ) ) {
+                     in_flight.push_back( std::move( current ) );
+                     flushed = false;
+                  }
+                  else {
+                     current->promise.set_exception( std::make_exception_ptr( pq::connection_error( PQerrorMessage( pgconn ) ) ) );
+                  }
+               }
+               if( !m_connection->is_open() ) {
+                  throw pq::connection_error( PQerrorMessage( pgconn ) );
+               }
+            }
+
+            if( in_flight.empty() ) {
+               if( m_stopping && ( m_queue.load() == nullptr ) ) {
+                  return;
+               }
+               m_waiting = true;
+               {
+                  std::unique_lock lock( m_mutex );
+                  m_condition.wait( lock, [ this ] { return ( m_queue.load() != nullptr ) || m_stopping; } );
+               }
+               m_waiting = false;
+               continue;
+            }
+
+            PGconn* pgconn = m_connection->underlying_raw_ptr();
+            if( !flushed ) {
+               switch( PQflush( pgconn ) ) {
+                  case 0:
+                     flushed = true;
+                     break;
+
+                  case 1:
+                     break;
+
+                     // LCOV_EXCL_START
+                  default:
+                     throw std::runtime_error( "PQflush() failed: " + m_connection->error_message() );
+                     // LCOV_EXCL_STOP
+               }
+            }
+
+            // statements queued in the meantime wake up the driver and are sent right away,
+            // announcing the wait before checking the queue works as for the idle wait above
+            const auto t = timeout();
+            const auto end = progress + t.value_or( std::chrono::milliseconds( 0 ) );
+            int wait = t ? internal::poll_timeout( end ) : -1;
+            if( ( m_wakeup->socket() < 0 ) && ( ( wait < 0 ) || ( wait > tick ) ) ) {
+               wait = tick;
+            }
+            std::vector< internal::poll_item > items = { { m_connection->socket(), !flushed, internal::poll_status::timeout } };
+            if( m_wakeup->socket() >= 0 ) {
+               items.push_back( { m_wakeup->socket(), false, internal::poll_status::timeout } );
+            }
+            m_polling = true;
+            if( m_queue.load() == nullptr ) {
+               std::ignore = internal::poll( items, wait );
+            }
+            m_polling = false;
+            m_wakeup->clear();
+
+            if( items[ 0 ].status == internal::poll_status::timeout ) {
+               if( t && ( std::chrono::steady_clock::now() >= end ) ) {
+                  throw timeout_reached( "timeout reached" );
+               }
+               continue;
+            }
+            if( PQconsumeInput( pgconn ) == 0 ) {
+               throw pq::connection_error( PQerrorMessage( pgconn ) );
+            }
+
+            while( !in_flight.empty() && ( PQisBusy( pgconn ) == 0 ) ) {
+               std::unique_ptr< PGresult, decltype( &PQclear ) > next( PQgetResult( pgconn ), &PQclear );
+               if( next ) {
+                  if( PQresultStatus( next.get() ) != PGRES_PIPELINE_SYNC ) {
+                     last = std::move( next );
+                  }
+                  continue;
+               }
+               if( !last ) {
+                  break;  // LCOV_EXCL_LINE
+               }
+               const auto current = std::move( in_flight.front() );
+               in_flight.pop_front();
+               progress = std::chrono::steady_clock::now();
+               try {
+                  current->promise.set_value( pq::result( last.release() ) );
+               }
+               catch( ... ) {
+                  current->promise.set_exception( std::current_exception() );
+               }
+            }
+            m_connection->handle_notifications();
+         }
+         catch( ... ) {
+            // the connection is broken or timed out, all statements in flight
+            // are lost and a new connection is opened for the next batch
+            const auto e = std::current_exception();
+            for( const auto& r : in_flight ) {
+               r->promise.set_exception( e );
+            }
+            in_flight.clear();
+            last.reset();
+            flushed = true;
+            m_connection.reset();
+         }
+      }
+   }
+
+}  // namespace tao::pq
@@ -0,0 +1,258 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/slow_query_log.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/deadline.hpp>
+
+namespace tao::pq
+{
+   namespace
+   {
+      // the statements executed for EXPLAIN must not be captured themselves
+      class suspended_hooks final
+      {
+      private:
+         pq::connection& m_connection;
+         const std::shared_ptr< statement_hooks > m_hooks;
+
+      public:
+         explicit suspended_hooks( pq::connection& c )
+            : m_connection( c ),
+              m_hooks( c.hooks() )
+         {
+            m_connection.reset_hooks();
+         }
+
+         suspended_hooks( const suspended_hooks& ) = delete;
+         suspended_hooks( suspended_hooks&& ) = delete;
+         void operator=( const suspended_hooks& ) = delete;
+         void operator=( suspended_hooks&& ) = delete;
+
+         ~suspended_hooks()
+         {
+            m_connection.set_hooks( m_hooks );
+         }
+      };
+
+      // the parameter list of PREPARE, types inferred by the server are declared as unknown
+      [[nodiscard]] auto parameter_types( transaction& tr, const std::vector< oid >& types ) -> std::string
+      {
+         if( types.empty() ) {
+            return std::string();
+         }
+         if( std::all_of( types.begin(), types.end(), []( const oid t ) { return t == oid::invalid; } ) ) {
+            std::string result = " ( unknown";
+            for( std::size_t i = 1; i < types.size(); ++i ) {
+               result += ", unknown";
+            }
+            return result + " )";
+         }
+         std::string array = "{";
+         for( const auto t : types ) {
+            if( array.size() > 1 ) {
+               array += ',';
+            }
+            array += std::to_string( static_cast< Oid >( t ) );
+         }
+         array += '}';
+         return " ( " + tr.execute( "SELECT string_agg( CASE WHEN t = 0 THEN 'unknown' ELSE format_type( t, NULL ) END, ', ' ORDER BY n ) FROM unnest( $1::OID[] ) WITH ORDINALITY AS s( t, n )", array ).as< std::string >() + " )";
+      }
+
+      [[nodiscard]] auto null_arguments( const std::size_t n ) -> std::string
+      {
+         if( n == 0 ) {
+            return std::string();
+         }
+         std::string result = " ( NULL";
+         for( std::size_t i = 1; i < n; ++i ) {
+            result += ", NULL";
+         }
+         return result + " )";
+      }
+
+   }  // namespace
+
+   slow_query_log::slow_query_log( const private_key /*unused*/, const std::chrono::microseconds threshold, const std::size_t capacity )
+      : m_threshold( threshold ),
+        m_capacity( capacity )
+   {
+      if( threshold.count() < 0 ) {
+         throw std::invalid_argument( "invalid threshold" );
+      }
+      if( capacity == 0 ) {
+         throw std::invalid_argument( "invalid capacity" );
+      }
+      m_entries.reserve( m_capacity );
+   }
+
+   auto slow_query_log::create( const std::chrono::microseconds threshold, const std::size_t capacity ) -> std::shared_ptr< slow_query_log >
+   {
+      return std::make_shared< slow_query_log >( private_key(), threshold, capacity );
+   }
+
+   void slow_query_log::set_explain( const std::shared_ptr< connection_pool >& pool, const double sample_rate, const std::chrono::milliseconds timeout )
+   {
+      if( !pool ) {
+         throw std::invalid_argument( "no connection pool" );
+      }
+      if( !( sample_rate > 0.0 ) || ( sample_rate > 1.0 ) ) {
+         throw std::invalid_argument( "invalid sample rate" );
+      }
+      if( timeout.count() <= 0 ) {
+         throw std::invalid_argument( "invalid timeout" );
+      }
+      const std::lock_guard lock( m_mutex );
+      m_explain_pool = pool;
+      m_explain_timeout = timeout;
+      m_sample_rate = sample_rate;
+      m_credit = 0.0;
+   }
+
+   void slow_query_log::reset_explain() noexcept
+   {
+      const std::lock_guard lock( m_mutex );
+      m_explain_pool.reset();
+      m_pending.clear();
+   }
+
+   auto slow_query_log::find( const std::size_t id ) noexcept -> slow_query*
+   {
+      if( ( id < m_first ) || ( m_captured - id > m_entries.size() ) ) {
+         return nullptr;  // cleared or replaced meanwhile
+      }
+      return &m_entries[ ( id - m_first ) % m_capacity ];
+   }
+
+   // the plan of a prepared statement without parameter values, i.e. the generic plan,
+   // is obtained with EXPLAIN EXECUTE and NULL arguments when custom plans are disabled
+   auto slow_query_log::explain( connection_pool& pool, const statement_event& e, const std::chrono::milliseconds timeout ) noexcept -> std::optional< std::string >
+   {
+      try {
+         const auto c = pool.connection( pq::deadline::after( timeout ) );
+         const suspended_hooks guard( *c );
+         std::optional< std::string > plan;
+         bool prepared = false;
+         try {
+            const auto tr = c->transaction();
+            tr->execute( "SET LOCAL plan_cache_mode = force_generic_plan" );
+            tr->execute( "PREPARE taopq_explain" + parameter_types( *tr, e.types ) + " AS " + e.statement );
+            prepared = true;
+            plan = tr->execute( "EXPLAIN ( ANALYZE OFF, FORMAT JSON ) EXECUTE taopq_explain" + null_arguments( e.types.size() ) ).as< std::string >();
+            tr->rollback();
+         }
+         catch( ... ) {
+            // statements that can not be prepared, e.g. utility statements, have no plan
+         }
+         // prepared statements are not transactional, they are removed even after the deadline
+         if( prepared ) {
+            c->reset_deadline();
+            c->execute( "DEALLOCATE taopq_explain" );
+         }
+         return plan;
+      }
+      catch( ... ) {
+         return std::nullopt;
+      }
+   }
+
+   void slow_query_log::on_result( const statement_event& e )
+   {
+      const auto duration = std::chrono::duration_cast< std::chrono::microseconds >( e.done - e.start );
+      if( duration < m_threshold ) {
+         return;
+      }
+      slow_query q;
+      q.event = e;
+      q.duration = duration;
+      q.captured = std::chrono::system_clock::now();
+
+      const std::lock_guard lock( m_mutex );
+      const auto id = m_captured++;
+
+      // the sampling is deterministic, every 1/sample_rate-th explainable statement is selected,
+      // the statement is only explained later by explain_pending() to never block the hook
+      if( m_explain_pool && !e.prepared ) {
+         m_credit += m_sample_rate;
+         if( m_credit >= 1.0 ) {
+            m_credit -= 1.0;
+            if( m_pending.size() == m_capacity ) {
+               m_pending.erase( m_pending.begin() );  // its entry is replaced anyway
+            }
+            m_pending.push_back( { id, e } );
+         }
+      }
+
+      if( m_entries.size() < m_capacity ) {
+         m_entries.emplace_back( std::move( q ) );
+      }
+      else {
+         m_entries[ m_next ] = std::move( q );
+         m_next = ( m_next + 1 ) % m_entries.size();
+      }
+   }
+
+   auto slow_query_log::explain_pending() -> std::size_t
+   {
+      std::vector< pending > todo;
+      std::shared_ptr< connection_pool > pool;
+      std::chrono::milliseconds timeout;
+      {
+         const std::lock_guard lock( m_mutex );
+         todo.swap( m_pending );
+         pool = m_explain_pool;
+         timeout = m_explain_timeout;
+      }
+      if( !pool ) {
+         return 0;
+      }
+      for( auto& p : todo ) {
+         {
+            const std::lock_guard lock( m_mutex );
+            if( slow_query_log::find( p.id ) == nullptr ) {
+               continue;
+            }
+         }
+         if( auto plan = explain( *pool, p.event, timeout ) ) {
+            const std::lock_guard lock( m_mutex );
+            if( auto* q = slow_query_log::find( p.id ) ) {
+               q->plan = std::move( plan );
+            }
+         }
+      }
+      return todo.size();
+   }
+
+   auto slow_query_log::entries() const -> std::vector< slow_query >
+   {
+      const std::lock_guard lock( m_mutex );
+      std::vector< slow_query > result;
+      result.reserve( m_entries.size() );
+      result.insert( result.end(), m_entries.begin() + static_cast< std::ptrdiff_t >( m_next ), m_entries.end() );
+      result.insert( result.end(), m_entries.begin(), m_entries.begin() + static_cast< std::ptrdiff_t >( m_next ) );
+      return result;
+   }
+
+   auto slow_query_log::captured() const noexcept -> std::size_t
+   {
+      const std::lock_guard lock( m_mutex );
+      return m_captured;
+   }
+
+   void slow_query_log::clear() noexcept
+   {
+      const std::lock_guard lock( m_mutex );
+      m_entries.clear();
+      m_next = 0;
+      m_first = m_captured;
+      m_pending.clear();
+   }
+
+}  // namespace tao::pq
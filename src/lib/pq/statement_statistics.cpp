@@ -0,0 +1,236 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include <tao/pq/statement_statistics.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+#include <tao/pq/internal/printf.hpp>
+
+namespace tao::pq
+{
+   namespace
+   {
+      // each power of two is divided into 2^sub_bits buckets
+      constexpr unsigned sub_bits = 5;
+      constexpr std::uint64_t sub_count = 1U << sub_bits;
+
+      [[nodiscard]] auto bucket( const std::uint64_t value ) noexcept -> std::size_t
+      {
+         if( value < 2 * sub_count ) {
+            return static_cast< std::size_t >( value );
+         }
+         unsigned msb = 0;
+         while( ( value >> ( msb + 1 ) ) != 0 ) {
+            ++msb;
+         }
+         const unsigned shift = msb - sub_bits;
+         return static_cast< std::size_t >( ( shift + 1 ) * sub_count + ( value >> shift ) - sub_count );
+      }
+
+      // the highest value that falls into the bucket
+      [[nodiscard]] auto highest( const std::size_t index ) noexcept -> std::uint64_t
+      {
+         if( index < 2 * sub_count ) {
+            return index;
+         }
+         const auto shift = index / sub_count - 1;
+         const auto sub = index % sub_count + sub_count;
+         return ( ( sub + 1 ) << shift ) - 1;
+      }
+
+      [[nodiscard]] auto is_identifier( const char c ) noexcept -> bool
+      {
+         return ( std::isalnum( static_cast< unsigned char >( c ) ) != 0 ) || ( c == '_' ) || ( c == '$' );
+      }
+
+   }  // namespace
+
+   void statement_histogram::record( const std::chrono::microseconds value )
+   {
+      const auto v = std::max( value, std::chrono::microseconds( 0 ) );
+      const auto index = bucket( static_cast< std::uint64_t >( v.count() ) );
+      if( index >= m_counts.size() ) {
+         m_counts.resize( index + 1 );
+      }
+      ++m_counts[ index ];
+      m_min = ( m_count == 0 ) ? v : std::min( m_min, v );
+      m_max = std::max( m_max, v );
+      m_sum += v;
+      ++m_count;
+   }
+
+   auto statement_histogram::mean() const noexcept -> std::chrono::microseconds
+   {
+      return ( m_count == 0 ) ? std::chrono::microseconds() : ( m_sum / static_cast< std::int64_t >( m_count ) );
+   }
+
+   auto statement_histogram::percentile( const double p ) const -> std::chrono::microseconds
+   {
+      if( ( p < 0 ) || ( p > 100 ) ) {
+         throw std::invalid_argument( "invalid percentile" );
+      }
+      if( m_count == 0 ) {
+         return {};
+      }
+      const auto rank = std::max< std::uint64_t >( 1, static_cast< std::uint64_t >( std::ceil( p / 100 * static_cast< double >( m_count ) ) ) );
+      std::uint64_t seen = 0;
+      for( std::size_t i = 0; i < m_counts.size(); ++i ) {
+         seen += m_counts[ i ];
+         if( seen >= rank ) {
+            return std::clamp( std::chrono::microseconds( highest( i ) ), m_min, m_max );
+         }
+      }
+      return m_max;  // LCOV_EXCL_LINE
+   }
+
+   auto statement_statistics::create() -> std::shared_ptr< statement_statistics >
+   {
+      return std::make_shared< statement_statistics >( private_key() );
+   }
+
+   auto statement_statistics::normalize( const std::string_view statement ) -> std::string
+   {
+      std::string result;
+      result.reserve( statement.size() );
+      std::size_t i = 0;
+      while( i < statement.size() ) {
+         const char c = statement[ i ];
+         if( std::isspace( static_cast< unsigned char >( c ) ) != 0 ) {
+            while( ( i < statement.size() ) && ( std::isspace( static_cast< unsigned char >( statement[ i ] ) ) != 0 ) ) {
+               ++i;
+            }
+            if( !result.empty() && ( i < statement.size() ) ) {
+               result += ' ';
+            }
+         }
+         else if( c == '\'' ) {
+            // string literals, quotes are escaped by doubling them
+            ++i;
+            while( i < statement.size() ) {
+               if( statement[ i++ ] == '\'' ) {
+                  if( ( i < statement.size() ) && ( statement[ i ] == '\'' ) ) {
+                     ++i;
+                     continue;
+                  }
+                  break;
+               }
+            }
+            result += '?';
+         }
+         else if( c == '"' ) {
+            // quoted identifiers are kept
+            const auto end = statement.find( '"', i + 1 );
+            const auto n = ( end == std::string_view::npos ) ? statement.size() - i : end - i + 1;
+            result += statement.substr( i, n );
+            i += n;
+         }
+         else if( ( std::isdigit( static_cast< unsigned char >( c ) ) != 0 ) && ( result.empty() || !is_identifier( result.back() ) ) ) {
+            // numeric literals
+            while( ( i < statement.size() ) && ( ( std::isalnum( static_cast< unsigned char >( statement[ i ] ) ) != 0 ) || ( statement[ i ] == '.' ) ) ) {
+               ++i;
+            }
+            result += '?';
+         }
+         else {
+            result += c;
+            ++i;
+         }
+      }
+      return result;
+   }
+
+   void statement_statistics::on_result( const statement_event& e )
+   {
+      auto key = e.prepared ? e.statement : normalize( e.statement );
+      const auto latency = std::chrono::duration_cast< std::chrono::microseconds >( e.done - e.start );
+      const std::lock_guard lock( m_mutex );
+      auto& r = m_records[ key ];
+      if( r.calls == 0 ) {
+         r.key = std::move( key );
+         r.prepared = e.prepared;
+      }
+      ++r.calls;
+      if( e.failed ) {
+         ++r.errors;
+      }
+      r.rows += e.rows;
+      r.bytes_sent += e.bytes_sent;
+      r.bytes_received += e.bytes_received;
+      r.latency.record( latency );
+   }
+
+   auto statement_statistics::records() const -> std::vector< statement_record >
+   {
+      std::vector< statement_record > result;
+      {
+         const std::lock_guard lock( m_mutex );
+         result.reserve( m_records.size() );
+         for( const auto& [ key, r ] : m_records ) {
+            result.push_back( r );
+         }
+      }
+      std::sort( result.begin(), result.end(), []( const statement_record& lhs, const statement_record& rhs ) { return lhs.latency.sum() > rhs.latency.sum(); } );
+      return result;
+   }
+
+   auto statement_statistics::record( const std::string_view key ) const -> std::optional< statement_record >
+   {
+      const std::lock_guard lock( m_mutex );
+      const auto it = m_records.find( std::string( key ) );
+      if( it != m_records.end() ) {
+         return it->second;
+      }
+      return std::nullopt;
+   }
+
+   void statement_statistics::reset() noexcept
+   {
+      const std::lock_guard lock( m_mutex );
+      m_records.clear();
+   }
+
+   auto statement_statistics::dump() const -> std::string
+   {
+      std::string result = "calls\terrors\trows\tbytes_sent\tbytes_received\ttotal_us\tmean_us\tp50_us\tp95_us\tp99_us\tmax_us\tstatement\n";
+      for( const auto& r : records() ) {
+         const auto& l = r.latency;
+         result += internal::printf( "%zu\t%zu\t%zu\t%zu\t%zu\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t",
+                                     r.calls,
+                                     r.errors,
+                                     r.rows,
+                                     r.bytes_sent,
+                                     r.bytes_received,
+                                     static_cast< long long >( l.sum().count() ),
+                                     static_cast< long long >( l.mean().count() ),
+                                     static_cast< long long >( l.percentile( 50 ).count() ),
+                                     static_cast< long long >( l.percentile( 95 ).count() ),
+                                     static_cast< long long >( l.percentile( 99 ).count() ),
+                                     static_cast< long long >( l.max().count() ) );
+         for( const char c : r.key ) {
+            result += ( ( c == '\t' ) || ( c == '\n' ) ) ? ' ' : c;
+         }
+         result += '\n';
+      }
+      return result;
+   }
+
+   void statement_statistics::dump( const std::string& filename ) const
+   {
+      const auto data = dump();
+      std::FILE* file = std::fopen( filename.c_str(), "w" );
+      if( file == nullptr ) {
+         throw std::runtime_error( "unable to open file: " + filename );
+      }
+      const auto written = std::fwrite( data.data(), 1, data.size(), file );
+      if( ( std::fclose( file ) != 0 ) || ( written != data.size() ) ) {
+         throw std::runtime_error( "unable to write file: " + filename );
+      }
+   }
+
+}  // namespace tao::pq
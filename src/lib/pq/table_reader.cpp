@@ -4,12 +4,16 @@
 
 #include <tao/pq/table_reader.hpp>
 
+#include <cassert>
 #include <chrono>
 #include <cstring>
+#include <memory>
 #include <tuple>
+#include <vector>
 
 #include <tao/pq/connection.hpp>
 #include <tao/pq/exception.hpp>
+#include <tao/pq/internal/table_reader_parse.hpp>
 #include <tao/pq/internal/unreachable.hpp>
 #include <tao/pq/result.hpp>
 
@@ -39,6 +43,9 @@ namespace tao::pq
             throw std::runtime_error( "unexpected empty query" );
 
          default:
+            if( m_transaction->connection()->m_hooks ) {
+               m_transaction->connection()->hook_result( result.get() );
+            }
             m_transaction->connection()->clear_results( end );
             internal::throw_sqlstate( result.get() );
       }
@@ -55,96 +62,114 @@ namespace tao::pq
       }
 
       const auto end = m_transaction->connection()->timeout_end();
-      std::ignore = pq::result( m_transaction->connection()->get_result( end ).release() );
+      auto result = m_transaction->connection()->get_result( end );
+      if( m_transaction->connection()->m_hooks ) {
+         m_transaction->connection()->hook_result( result.get() );
+      }
+      std::ignore = pq::result( result.release() );
       m_transaction.reset();
       m_previous.reset();
       return {};
    }
 
-   auto table_reader::parse_data() noexcept -> bool
+   auto table_reader::get_row_async() -> awaitable< bool >
    {
-      m_data.clear();
-      char* read = m_buffer.get();
-      if( read == nullptr ) {
-         return false;
-      }
-      char* write = read;
-      char* begin = write;
-      while( auto* pos = std::strpbrk( read, "\t\\\n" ) ) {
-         if( const auto prefix_size = pos - read ) {
-            std::memmove( write, read, prefix_size );
-            write += prefix_size;
+      return awaitable< bool >( std::make_unique< internal::table_row_operation >( *this ) );
+   }
+
+   namespace internal
+   {
+      auto table_reader_parse( char* read, std::vector< const char* >& data ) noexcept -> bool
+      {
+         data.clear();
+         if( read == nullptr ) {
+            return false;
          }
-         switch( *pos ) {
-            case '\t':
-               m_data.emplace_back( begin );
-               *write++ = '\0';
-               begin = write = read = ++pos;
-               break;
-
-            case '\\':
-               read = pos + 1;
-               switch( *read++ ) {
-                  case 'N':
-                     assert( write == begin );
-                     m_data.emplace_back( nullptr );
-                     switch( *read ) {
-                        case '\t':
-                           begin = write = ++read;
-                           break;
-
-                        case '\n':
-                           return true;
-
-                        default:                // LCOV_EXCL_LINE
-                           TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
-                     }
-                     break;
-
-                  case 'b':
-                     *write++ = '\b';
-                     break;
-
-                  case 'f':
-                     *write++ = '\f';
-                     break;
-
-                  case 'n':
-                     *write++ = '\n';
-                     break;
-
-                  case 'r':
-                     *write++ = '\r';
-                     break;
-
-                  case 't':
-                     *write++ = '\t';
-                     break;
-
-                  case 'v':
-                     *write++ = '\v';
-                     break;
-
-                  case '\\':
-                     *write++ = '\\';
-                     break;
-
-                  default:                // LCOV_EXCL_LINE
-                     TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
-               }
-               break;
-
-            case '\n':
-               m_data.emplace_back( begin );
-               *write++ = '\0';
-               assert( m_data.size() == columns() );
-               return true;
-
-            default:                // LCOV_EXCL_LINE
-               TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
+         char* write = read;
+         char* begin = write;
+         while( auto* pos = std::strpbrk( read, "\t\\\n" ) ) {
+            if( const auto prefix_size = pos - read ) {
+               std::memmove( write, read, prefix_size );
+               write += prefix_size;
+            }
+            switch( *pos ) {
+               case '\t':
+                  data.emplace_back( begin );
+                  *write++ = '\0';
+                  begin = write = read = ++pos;
+                  break;
+
+               case '\\':
+                  read = pos + 1;
+                  switch( *read++ ) {
+                     case 'N':
+                        assert( write == begin );
+                        data.emplace_back( nullptr );
+                        switch( *read ) {
+                           case '\t':
+                              begin = write = ++read;
+                              break;
+
+                           case '\n':
+                              return true;
+
+                           default:                // LCOV_EXCL_LINE
+                              TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
+                        }
+                        break;
+
+                     case 'b':
+                        *write++ = '\b';
+                        break;
+
+                     case 'f':
+                        *write++ = '\f';
+                        break;
+
+                     case 'n':
+                        *write++ = '\n';
+                        break;
+
+                     case 'r':
+                        *write++ = '\r';
+                        break;
+
+                     case 't':
+                        *write++ = '\t';
+                        break;
+
+                     case 'v':
+                        *write++ = '\v';
+                        break;
+
+                     case '\\':
+                        *write++ = '\\';
+                        break;
+
+                     default:                // LCOV_EXCL_LINE
+                        TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
+                  }
+                  break;
+
+               case '\n':
+                  data.emplace_back( begin );
+                  *write++ = '\0';
+                  return true;
+
+               default:                // LCOV_EXCL_LINE
+                  TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
+            }
          }
+         TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
       }
-      TAO_PQ_UNREACHABLE;  // LCOV_EXCL_LINE
+
+   }  // namespace internal
+
+   auto table_reader::parse_data() noexcept -> bool
+   {
+      const bool result = internal::table_reader_parse( m_buffer.get(), m_data );
+      assert( !result || ( m_data.size() == columns() ) );
+      return result;
    }
 
    auto table_reader::begin() -> table_reader::const_iterator
@@ -5,6 +5,7 @@
 #include <tao/pq/table_writer.hpp>
 
 #include <chrono>
+#include <memory>
 #include <tuple>
 
 #include <libpq-fe.h>
@@ -50,6 +51,9 @@ namespace tao::pq
             throw std::runtime_error( "unexpected empty query" );
 
          default:
+            if( m_transaction->connection()->m_hooks ) {
+               m_transaction->connection()->hook_result( result.get() );
+            }
             m_transaction->connection()->clear_results( end );
             internal::throw_sqlstate( result.get() );
       }
@@ -60,6 +64,16 @@ namespace tao::pq
       m_transaction->connection()->put_copy_data( data.data(), data.size() );
    }
 
+   auto table_writer::flush_async() -> awaitable< void >
+   {
+      return awaitable< void >( std::make_unique< internal::table_flush_operation >( *this ) );
+   }
+
+   auto table_writer::commit_async() -> awaitable< std::size_t >
+   {
+      return awaitable< std::size_t >( std::make_unique< internal::table_commit_operation >( *this ) );
+   }
+
    auto table_writer::commit() -> std::size_t
    {
       m_transaction->connection()->put_copy_end();
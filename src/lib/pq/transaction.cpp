@@ -2,8 +2,10 @@
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
+#include <memory>
 #include <stdexcept>
 
+#include <tao/pq/cancel_handle.hpp>
 #include <tao/pq/connection.hpp>
 #include <tao/pq/oid.hpp>
 #include <tao/pq/transaction.hpp>
@@ -131,14 +133,40 @@ namespace tao::pq
       m_connection->send_params( statement, n_params, types, values, lengths, formats );
    }
 
+   void transaction::defer_params( const char* statement,
+                                   const int n_params,
+                                   const Oid types[],
+                                   const char* const values[],
+                                   const int lengths[],
+                                   const int formats[] )
+   {
+      m_connection->send_deferred( statement, n_params, types, values, lengths, formats );
+   }
+
+   void transaction::sync_deferred()
+   {
+      m_connection->sync_deferred( m_connection->timeout_end() );
+   }
+
+   void transaction::check_asynchronous() const
+   {
+      check_current_transaction();
+      if( !m_connection->scheduler() ) {
+         throw std::logic_error( "invalid asynchronous statement, no scheduler set" );
+      }
+      if( m_connection->has_deferred() ) {
+         throw std::logic_error( "invalid asynchronous statement, deferred statements pending" );
+      }
+   }
+
    auto transaction::get_result( const std::chrono::steady_clock::time_point start ) -> result
    {
       check_current_transaction();
       const auto end = m_connection->timeout_end( start );
 
-      auto result = m_connection->get_result( end );
-      if( result ) {
-         switch( PQresultStatus( result.get() ) ) {
+      std::unique_ptr< PGresult, decltype( &PQclear ) > result( nullptr, &PQclear );
+      if( auto first = m_connection->get_result( end ) ) {
+         switch( PQresultStatus( first.get() ) ) {
             case PGRES_COPY_IN:
                m_connection->put_copy_end( "unexpected COPY FROM statement" );
                break;
@@ -151,12 +179,23 @@ namespace tao::pq
 
             default:;
          }
+         m_connection->collect_result( result, std::move( first ), end );
          while( auto next = m_connection->get_result( end ) ) {
-            result = std::move( next );
+            m_connection->collect_result( result, std::move( next ), end );
          }
+         m_connection->check_result_limit( result.get() );
+      }
+      if( m_connection->m_hooks ) {
+         m_connection->hook_result( result.get() );
       }
 
-      return pq::result( result.release() );
+      return pq::result( result.release(), m_connection->m_result_memory );
+   }
+
+   auto transaction::get_result_async( const std::chrono::steady_clock::time_point start ) -> awaitable< result >
+   {
+      check_asynchronous();
+      return awaitable< result >( std::make_unique< internal::result_operation >( shared_from_this(), start ) );
    }
 
    auto transaction::subtransaction() -> std::shared_ptr< transaction >
@@ -168,18 +207,22 @@ namespace tao::pq
       return std::make_shared< internal::nested_subtransaction >( m_connection );
    }
 
+   auto transaction::cancel_handle() const -> std::shared_ptr< pq::cancel_handle >
+   {
+      check_current_transaction();
+      return m_connection->cancel_handle();
+   }
+
    void transaction::commit()
    {
       check_current_transaction();
       try {
          v_commit();
       }
-      // LCOV_EXCL_START
       catch( ... ) {
          v_reset();
          throw;
       }
-      // LCOV_EXCL_STOP
       v_reset();
    }
 
@@ -187,14 +230,16 @@ namespace tao::pq
    {
       check_current_transaction();
       try {
+         if( !v_is_direct() ) {
+            // errors of deferred statements are irrelevant when rolling back
+            m_connection->discard_deferred( m_connection->timeout_end() );
+         }
          v_rollback();
       }
-      // LCOV_EXCL_START
       catch( ... ) {
          v_reset();
          throw;
       }
-      // LCOV_EXCL_STOP
       v_reset();
    }
 
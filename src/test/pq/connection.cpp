@@ -5,9 +5,13 @@
 #include "../getenv.hpp"
 #include "../macros.hpp"
 
+#include <cstring>
+#include <thread>
 #include <tuple>
 
+#include <tao/pq/cancel_handle.hpp>
 #include <tao/pq/connection.hpp>
+#include <tao/pq/internal/poll.hpp>
 
 void run()
 {
@@ -126,6 +130,101 @@ void run()
    using namespace std::chrono_literals;
    connection->set_timeout( 100ms );
    TEST_THROWS( connection->execute( "SELECT pg_sleep( .5 )" ) );
+
+   // cancel the statement instead of closing the connection
+   const auto connection2 = tao::pq::connection::create( connection_string );
+   connection2->set_timeout( 100ms );
+   connection2->set_cancel_on_timeout( 1s );
+   TEST_THROWS( connection2->execute( "SELECT pg_sleep( 2 )" ) );
+   TEST_ASSERT( connection2->is_open() );
+   TEST_ASSERT( connection2->is_idle() );
+   TEST_ASSERT( connection2->execute( "SELECT 42" ).as< int >() == 42 );
+   {
+      const auto tr = connection2->transaction();
+      TEST_THROWS( tr->execute( "SELECT pg_sleep( 2 )" ) );
+      TEST_ASSERT( connection2->is_open() );
+   }
+   TEST_ASSERT( connection2->is_idle() );
+   TEST_ASSERT( connection2->execute( "SELECT 42" ).as< int >() == 42 );
+
+   // cancel a running statement from another thread
+   connection2->reset_timeout();
+   const auto handle = connection2->cancel_handle();
+   std::thread watchdog( [ & ] {
+      std::this_thread::sleep_for( 200ms );
+      handle->cancel( 1s );
+   } );
+   TEST_THROWS( connection2->execute( "SELECT pg_sleep( 10 )" ) );
+   watchdog.join();
+   TEST_ASSERT( connection2->is_idle() );
+   TEST_ASSERT( connection2->execute( "SELECT 42" ).as< int >() == 42 );
+
+   // cancel without blocking, as an event loop would
+   std::thread poller( [ & ] {
+      std::this_thread::sleep_for( 200ms );
+      handle->start();
+      while( !handle->poll() ) {
+         std::ignore = tao::pq::internal::poll( handle->socket(), handle->wait_for_write(), 1000 );
+      }
+   } );
+   TEST_THROWS( connection2->execute( "SELECT pg_sleep( 10 )" ) );
+   poller.join();
+   TEST_ASSERT( connection2->is_idle() );
+   TEST_ASSERT( connection2->execute( "SELECT 42" ).as< int >() == 42 );
+   TEST_THROWS( handle->poll() );
+
+   // spin before blocking
+   connection2->set_busy_poll( 50us );
+   TEST_ASSERT( connection2->busy_poll() == 50us );
+   TEST_ASSERT( connection2->execute( "SELECT 42" ).as< int >() == 42 );
+   TEST_EXECUTE( connection2->execute( "SELECT pg_sleep( .1 )" ) );
+   TEST_ASSERT( connection2->execute( "SELECT 42" ).as< int >() == 42 );
+
+   // the spin budget shrinks for slow statements and recovers for fast ones
+   connection2->set_busy_poll( 20ms );
+   TEST_ASSERT( connection2->spin_budget() == 20ms );
+   for( int i = 0; i < 3; ++i ) {
+      TEST_EXECUTE( connection2->execute( "SELECT pg_sleep( .05 )" ) );
+   }
+   TEST_ASSERT( connection2->spin_budget() < 20ms );
+   for( int i = 0; ( i < 100 ) && ( connection2->spin_budget() < 20ms ); ++i ) {
+      TEST_ASSERT( connection2->execute( "SELECT 42" ).as< int >() == 42 );
+   }
+   TEST_ASSERT( connection2->spin_budget() == 20ms );
+   TEST_EXECUTE( connection2->execute( "SELECT pg_sleep( .05 )" ) );
+   TEST_ASSERT( connection2->spin_budget() < 20ms );
+   connection2->set_busy_poll( 20ms );
+   TEST_ASSERT( connection2->spin_budget() == 20ms );
+
+   connection2->reset_busy_poll();
+   TEST_ASSERT( !connection2->busy_poll() );
+   TEST_ASSERT( connection2->spin_budget() == std::chrono::microseconds( 0 ) );
+
+   // I/O counters
+   connection2->reset_io_statistics();
+   TEST_ASSERT( connection2->io_statistics().statements == 0 );
+   TEST_ASSERT( connection2->execute( "SELECT 1 FROM pg_sleep( .05 )" ).as< int >() == 1 );
+   {
+      const auto io = connection2->io_statistics();
+      TEST_ASSERT( io.statements == 1 );
+      TEST_ASSERT( io.round_trips == 1 );
+      TEST_ASSERT( io.waits >= 1 );
+      TEST_ASSERT( io.wait_time >= 40ms );
+      TEST_ASSERT( io.bytes_sent == std::strlen( "SELECT 1 FROM pg_sleep( .05 )" ) );
+      TEST_ASSERT( io.bytes_received > 0 );
+   }
+
+   // deferred statements share a single round trip
+   connection2->reset_io_statistics();
+   {
+      const auto tr = connection2->transaction();
+      tr->defer( "SELECT 1" );
+      tr->defer( "SELECT 2" );
+      TEST_ASSERT( tr->execute( "SELECT 3" ).as< int >() == 3 );
+      tr->commit();
+   }
+   TEST_ASSERT( connection2->io_statistics().statements == 5 );
+   TEST_ASSERT( connection2->io_statistics().round_trips == 3 );
 }
 
 auto main() -> int  // NOLINT(bugprone-exception-escape)
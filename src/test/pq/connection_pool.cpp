@@ -5,7 +5,13 @@
 #include "../getenv.hpp"
 #include "../macros.hpp"
 
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <tao/pq/connection_pool.hpp>
+#include <tao/pq/exception.hpp>
 
 void run()
 {
@@ -26,6 +32,179 @@ void run()
    TEST_ASSERT( pool2->connection()->execute( "SELECT 4" ).as< int >() == 4 );
    TEST_ASSERT( conn->execute( "SELECT 5" ).as< int >() == 5 );
    TEST_ASSERT( pool2->connection()->execute( "SELECT 6" ).as< int >() == 6 );
+
+   using namespace std::chrono_literals;
+   const auto pool3 = tao::pq::connection_pool::create( connection_string );
+   pool3->set_cancel_on_timeout( 1s );
+   TEST_ASSERT( pool3->connection( tao::pq::deadline::after( 10s ) )->execute( "SELECT 7" ).as< int >() == 7 );
+   TEST_ASSERT( pool3->connection( tao::pq::deadline::after( 10s ) )->deadline() );
+   TEST_ASSERT( !pool3->connection()->deadline() );
+   TEST_THROWS( pool3->connection( tao::pq::deadline::after( 0s ) ) );
+   {
+      const auto c = pool3->connection( tao::pq::deadline::after( 100ms ) );
+      TEST_THROWS( c->execute( "SELECT pg_sleep( 1 )" ) );
+      TEST_ASSERT( c->is_open() );
+   }
+   TEST_ASSERT( tao::pq::connection::create( connection_string, tao::pq::deadline::after( 10s ) )->execute( "SELECT 8" ).as< int >() == 8 );
+
+   // coalescing identical concurrent statements
+   TEST_ASSERT( pool->coalesced_hits() == 0 );
+   TEST_ASSERT( pool->coalesced_misses() == 0 );
+   TEST_ASSERT( pool->execute_coalesced( "SELECT $1::INTEGER", 9 ).as< int >() == 9 );
+   TEST_ASSERT( pool->execute_coalesced( "SELECT $1::INTEGER", 10 ).as< int >() == 10 );
+   TEST_ASSERT( pool->coalesced_misses() == 2 );
+   TEST_THROWS( pool->execute_coalesced( "FOO BAR BAZ" ) );
+   {
+      std::vector< std::thread > threads;
+      for( int i = 0; i < 8; ++i ) {
+         threads.emplace_back( [ & ] {
+            TEST_ASSERT( pool->execute_coalesced( "SELECT $1::INTEGER FROM pg_sleep( .2 )", 11 ).as< int >() == 11 );
+         } );
+      }
+      for( auto& t : threads ) {
+         t.join();
+      }
+   }
+   TEST_ASSERT( pool->coalesced_hits() + pool->coalesced_misses() == 11 );
+   TEST_ASSERT( pool->coalesced_hits() > 0 );
+
+   // admission control
+   const auto pool4 = tao::pq::connection_pool::create( connection_string );
+   TEST_THROWS( pool4->set_admission( 0, { { "interactive" } } ) );
+   TEST_THROWS( pool4->set_admission( 2, {} ) );
+   TEST_THROWS( pool4->set_admission( 2, { { "interactive", 0 } } ) );
+   TEST_ASSERT( pool4->admission_statistics().empty() );
+   pool4->set_admission( 2, { { "interactive", 4 }, { "batch", 1, 1 } }, tao::pq::admission_policy::strict_priority );
+   {
+      auto b1 = pool4->connection( 1 );
+      TEST_THROWS( pool4->connection( 1, tao::pq::deadline::after( 50ms ) ) );  // per class limit
+      const auto i1 = pool4->connection( 0 );
+      TEST_THROWS( pool4->connection( tao::pq::deadline::after( 50ms ) ) );  // pool limit
+      TEST_THROWS( pool4->connection( 2 ) );
+
+      // the waiting interactive request is admitted first
+      std::vector< int > order;
+      std::mutex mutex;
+      std::vector< std::thread > threads;
+      threads.emplace_back( [ & ] {
+         const auto c = pool4->connection( 1 );
+         const std::lock_guard lock( mutex );
+         order.push_back( 1 );
+      } );
+      std::this_thread::sleep_for( 50ms );
+      threads.emplace_back( [ & ] {
+         const auto c = pool4->connection( 0 );
+         const std::lock_guard lock( mutex );
+         order.push_back( 0 );
+      } );
+      std::this_thread::sleep_for( 50ms );
+      const auto stats = pool4->admission_statistics();
+      TEST_ASSERT( stats.size() == 2 );
+      TEST_ASSERT( stats[ 0 ].name == "interactive" );
+      TEST_ASSERT( stats[ 0 ].waiting == 1 );
+      TEST_ASSERT( stats[ 1 ].waiting == 1 );
+      TEST_ASSERT( stats[ 1 ].rejected == 1 );
+      pool4->detach( i1 );
+      threads[ 1 ].join();
+      TEST_ASSERT( order == std::vector< int >{ 0 } );
+      TEST_ASSERT( b1->execute( "SELECT 12" ).as< int >() == 12 );
+      b1.reset();
+      threads[ 0 ].join();
+      TEST_ASSERT( order == std::vector< int >{ 0, 1 } );
+   }
+   const auto stats = pool4->admission_statistics();
+   TEST_ASSERT( stats[ 0 ].in_use == 0 );
+   TEST_ASSERT( stats[ 1 ].in_use == 0 );
+   TEST_ASSERT( stats[ 1 ].admitted == 2 );
+   TEST_ASSERT( stats[ 0 ].max_wait >= 50ms );
+   pool4->reset_admission();
+   TEST_ASSERT( pool4->admission_statistics().empty() );
+
+   // adaptive sizing
+   const auto pool5 = tao::pq::connection_pool::create( connection_string );
+   TEST_ASSERT( !pool5->sizing_statistics() );
+   TEST_THROWS( pool5->set_adaptive_sizing( 0, 4 ) );
+   TEST_THROWS( pool5->set_adaptive_sizing( 4, 2 ) );
+   pool5->set_adaptive_sizing( 1, 4 );
+   TEST_ASSERT( pool5->sizing_statistics()->limit == 1 );
+   TEST_ASSERT( pool5->sizing_statistics()->max_connections == 4 );
+   {
+      std::vector< std::thread > threads;
+      for( int i = 0; i < 4; ++i ) {
+         threads.emplace_back( [ & ] {
+            for( int j = 0; j < 10; ++j ) {
+               TEST_ASSERT( pool5->execute( "SELECT 1 FROM pg_sleep( .02 )" ).as< int >() == 1 );
+            }
+         } );
+      }
+      for( auto& t : threads ) {
+         t.join();
+      }
+   }
+   const auto sizing = pool5->sizing_statistics();
+   TEST_ASSERT( sizing->increases > 0 );
+   TEST_ASSERT( sizing->limit > 1 );
+   TEST_ASSERT( sizing->limit <= 4 );
+   TEST_ASSERT( pool5->size() <= sizing->limit );
+   pool5->reset_adaptive_sizing();
+   TEST_ASSERT( !pool5->sizing_statistics() );
+
+   // session settings
+   const auto pool6 = tao::pq::connection_pool::create( connection_string );
+   const tao::pq::session_settings tenant = { { "search_path", "tenant" }, { "work_mem", "5MB" } };
+   {
+      const auto c = pool6->connection( tenant );
+      TEST_ASSERT( c->execute( "SHOW work_mem" ).as< std::string >() == "5MB" );
+      TEST_ASSERT( c->execute( "SHOW search_path" ).as< std::string >() == "tenant" );
+   }
+   TEST_ASSERT( pool6->session_migrations() == 1 );
+   {
+      const auto c = pool6->connection( tenant );
+      TEST_ASSERT( c->execute( "SHOW work_mem" ).as< std::string >() == "5MB" );
+   }
+   TEST_ASSERT( pool6->session_hits() == 1 );
+   TEST_ASSERT( pool6->session_migrations() == 1 );
+   TEST_ASSERT( pool6->execute( "SHOW work_mem" ).as< std::string >() != "5MB" );
+   TEST_ASSERT( pool6->session_migrations() == 2 );
+   TEST_ASSERT( pool6->size() == 1 );
+
+   // statistics
+   const auto pool7 = tao::pq::connection_pool::create( connection_string );
+   {
+      const auto c1 = pool7->connection();
+      const auto c2 = pool7->connection();
+      const auto s = pool7->statistics();
+      TEST_ASSERT( s.in_use == 2 );
+      TEST_ASSERT( s.idle == 0 );
+      TEST_ASSERT( s.created == 2 );
+      TEST_ASSERT( s.checkout_latency.count == 2 );
+   }
+   TEST_ASSERT( pool7->execute( "SELECT 1" ).as< int >() == 1 );
+   {
+      const auto s = pool7->statistics();
+      TEST_ASSERT( s.in_use == 0 );
+      TEST_ASSERT( s.idle == 2 );
+      TEST_ASSERT( s.total == 2 );
+      TEST_ASSERT( s.created == 2 );
+      TEST_ASSERT( s.hold_time.count == 3 );
+   }
+   pool7->detach( pool7->connection() );
+   TEST_ASSERT( pool7->statistics().in_use == 0 );
+   TEST_ASSERT( pool7->statistics().idle == 1 );
+   TEST_ASSERT( tao::pq::to_prometheus( pool7->statistics() ).find( "taopq_pool_connections_created_total 2\n" ) != std::string::npos );
+
+   // result memory
+   {
+      const auto r = pool7->execute( "SELECT generate_series( 1, 1000 )" );
+      TEST_ASSERT( pool7->result_memory() == r.memory_size() );
+      TEST_ASSERT( pool7->statistics().result_memory == r.memory_size() );
+   }
+   TEST_ASSERT( pool7->result_memory() == 0 );
+   TEST_THROWS( pool7->set_result_limit( 0 ) );
+   pool7->set_result_limit( 10000 );
+   TEST_THROWS( pool7->execute( "SELECT generate_series( 1, 100000 )" ) );
+   pool7->reset_result_limit();
+   TEST_ASSERT( pool7->execute( "SELECT generate_series( 1, 100000 )" ).size() == 100000 );
 }
 
 auto main() -> int  // NOLINT(bugprone-exception-escape)
@@ -0,0 +1,144 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#if defined( __cpp_impl_coroutine ) && defined( __linux__ )
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <string>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/coroutine.hpp>
+#include <tao/pq/event_loop.hpp>
+#include <tao/pq/table_reader.hpp>
+#include <tao/pq/table_writer.hpp>
+
+// a minimal fire-and-forget coroutine type
+struct task
+{
+   struct promise_type
+   {
+      auto get_return_object() noexcept -> task
+      {
+         return {};
+      }
+
+      auto initial_suspend() noexcept -> std::suspend_never
+      {
+         return {};
+      }
+
+      auto final_suspend() noexcept -> std::suspend_never
+      {
+         return {};
+      }
+
+      void return_void() noexcept {}
+
+      void unhandled_exception() noexcept
+      {
+         std::terminate();
+      }
+   };
+};
+
+auto query( std::shared_ptr< tao::pq::connection > connection, const int i, int& sum ) -> task
+{
+   const auto result = co_await connection->direct()->execute_async( "SELECT $1::INTEGER FROM pg_sleep( .1 )", i );
+   sum += result.as< int >();
+}
+
+auto failing( std::shared_ptr< tao::pq::connection > connection, bool& done ) -> task
+{
+   TEST_THROWS( co_await connection->direct()->execute_async( "FOO BAR BAZ" ) );
+   done = true;
+}
+
+auto copy( std::shared_ptr< tao::pq::connection > connection, int& rows ) -> task
+{
+   const auto tr = connection->transaction();
+   tr->execute( "CREATE TEMPORARY TABLE tao_coroutine_test ( a INTEGER, b TEXT )" );
+   {
+      tao::pq::table_writer tw( tr, "COPY tao_coroutine_test ( a, b ) FROM STDIN" );
+      for( int i = 0; i < 1000; ++i ) {
+         tw.insert( i, "row " + std::to_string( i ) );
+         if( i % 100 == 0 ) {
+            co_await tw.flush_async();
+         }
+      }
+      TEST_ASSERT( co_await tw.commit_async() == 1000 );
+   }
+   {
+      tao::pq::table_reader reader( tr, "COPY tao_coroutine_test ( a, b ) TO STDOUT" );
+      while( co_await reader.get_row_async() ) {
+         TEST_ASSERT( reader.row().get< std::string >( 1 ) == "row " + std::to_string( reader.row().get< int >( 0 ) ) );
+         ++rows;
+      }
+   }
+   tr->commit();
+}
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   const auto loop = tao::pq::event_loop::create();
+
+   // a connection without scheduler can not be used asynchronously
+   const auto connection = tao::pq::connection::create( connection_string );
+   bool done = false;
+   failing( connection, done );
+   TEST_ASSERT( done );
+
+   connection->set_scheduler( loop );
+   done = false;
+   failing( connection, done );
+   TEST_ASSERT( !done );
+   loop->run();
+   TEST_ASSERT( done );
+
+   int sum = 0;
+   for( int i = 0; i < 4; ++i ) {
+      const auto c = tao::pq::connection::create( connection_string );
+      c->set_scheduler( loop );
+      query( c, i, sum );
+   }
+   loop->run();
+   TEST_ASSERT( sum == 0 + 1 + 2 + 3 );
+
+   int rows = 0;
+   copy( connection, rows );
+   loop->run();
+   TEST_ASSERT( rows == 1000 );
+}
+
+#else
+
+void run()
+{}
+
+#endif
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#if defined( __linux__ )
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/event_loop.hpp>
+#include <tao/pq/exception.hpp>
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   const auto loop = tao::pq::event_loop::create();
+   TEST_ASSERT( loop->empty() );
+
+   std::vector< std::shared_ptr< tao::pq::connection > > connections;
+   for( int i = 0; i < 4; ++i ) {
+      connections.push_back( tao::pq::connection::create( connection_string ) );
+   }
+
+   int sum = 0;
+   int errors = 0;
+   const auto on_error = [ & ]( std::exception_ptr /*unused*/ ) { ++errors; };
+   for( int i = 0; i < 4; ++i ) {
+      loop->execute(
+         connections[ i ], [ & ]( tao::pq::result&& r ) { sum += r.as< int >(); }, on_error, "SELECT $1::INTEGER FROM pg_sleep( .1 )", i );
+   }
+   TEST_ASSERT( !loop->empty() );
+
+   // the connections are busy until the statements are completed
+   TEST_THROWS( connections[ 0 ]->direct() );
+
+   loop->run();
+   TEST_ASSERT( loop->empty() );
+   TEST_ASSERT( errors == 0 );
+   TEST_ASSERT( sum == 0 + 1 + 2 + 3 );
+
+   // errors are reported to the error handler
+   std::exception_ptr error;
+   loop->execute(
+      connections[ 0 ], []( tao::pq::result&& /*unused*/ ) {}, [ & ]( std::exception_ptr e ) { error = e; }, "FOO BAR BAZ" );
+   loop->run();
+   TEST_ASSERT( error );
+   TEST_THROWS( std::rethrow_exception( error ) );
+   TEST_ASSERT( connections[ 0 ]->execute( "SELECT 42" ).as< int >() == 42 );
+
+   // handlers can start the next statement on the same connection
+   int chained = 0;
+   loop->execute(
+      connections[ 1 ], [ & ]( tao::pq::result&& r ) {
+         chained = r.as< int >();
+         loop->execute(
+            connections[ 1 ], [ & ]( tao::pq::result&& s ) { chained += s.as< int >(); }, on_error, "SELECT 2" );
+      },
+      on_error,
+      "SELECT 1" );
+   loop->run();
+   TEST_ASSERT( chained == 3 );
+
+   // timeouts are honored
+   using namespace std::chrono_literals;
+   connections[ 2 ]->set_timeout( 100ms );
+   connections[ 2 ]->set_cancel_on_timeout( 1s );
+   error = nullptr;
+   loop->execute(
+      connections[ 2 ], []( tao::pq::result&& /*unused*/ ) {}, [ & ]( std::exception_ptr e ) { error = e; }, "SELECT pg_sleep( 1 )" );
+   loop->run();
+   TEST_ASSERT( error );
+   TEST_THROWS( std::rethrow_exception( error ) );
+   TEST_ASSERT( connections[ 2 ]->is_idle() );
+
+   // unexpected COPY TO statements are cancelled without blocking the event loop
+   error = nullptr;
+   loop->execute(
+      connections[ 2 ], []( tao::pq::result&& /*unused*/ ) {}, [ & ]( std::exception_ptr e ) { error = e; }, "COPY ( SELECT generate_series( 1, 1000000 ) ) TO STDOUT" );
+   loop->run();
+   TEST_ASSERT( error );
+   TEST_THROWS( std::rethrow_exception( error ) );
+   TEST_ASSERT( connections[ 2 ]->is_idle() );
+   TEST_ASSERT( connections[ 2 ]->execute( "SELECT 42" ).as< int >() == 42 );
+
+   // the result limit is enforced without blocking the event loop
+   connections[ 2 ]->set_result_limit( 1000 );
+   error = nullptr;
+   loop->execute(
+      connections[ 2 ], []( tao::pq::result&& /*unused*/ ) {}, [ & ]( std::exception_ptr e ) { error = e; }, "SELECT generate_series( 1, 1000000 )" );
+   loop->run();
+   TEST_ASSERT( error );
+   TEST_THROWS( std::rethrow_exception( error ) );
+   TEST_ASSERT( connections[ 2 ]->is_idle() );
+   connections[ 2 ]->reset_result_limit();
+   TEST_ASSERT( connections[ 2 ]->execute( "SELECT 42" ).as< int >() == 42 );
+
+   // statements within transactions
+   const auto tr = connections[ 3 ]->transaction();
+   tr->execute( "CREATE TEMPORARY TABLE tao_event_loop_test ( a INTEGER )" );
+   loop->execute(
+      tr, []( tao::pq::result&& r ) { TEST_ASSERT( r.rows_affected() == 1 ); }, on_error, "INSERT INTO tao_event_loop_test VALUES ( $1 )", 42 );
+   loop->run();
+   TEST_ASSERT( tr->execute( "SELECT a FROM tao_event_loop_test" ).as< int >() == 42 );
+   tr->commit();
+   TEST_ASSERT( errors == 0 );
+
+   // idle loops return after the timeout
+   TEST_ASSERT( loop->run_once( 10ms ) == 0 );
+}
+
+#else
+
+void run()
+{}
+
+#endif
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
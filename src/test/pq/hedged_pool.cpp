@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/hedged_pool.hpp>
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   using namespace std::chrono_literals;
+   const auto primary = tao::pq::connection_pool::create( connection_string + " application_name=hedged_primary" );
+   const auto secondary = tao::pq::connection_pool::create( connection_string );
+   const auto pool = tao::pq::hedged_pool::create( primary, secondary );
+
+   // no hedging without enough samples
+   TEST_ASSERT( !pool->hedge_delay() );
+   for( int i = 0; i < 20; ++i ) {
+      TEST_ASSERT( pool->execute( "SELECT $1::INTEGER", i ).as< int >() == i );
+   }
+   TEST_ASSERT( pool->hedge_delay() );
+   TEST_ASSERT( pool->hedges() == 0 );
+
+   // a statement which is slow on the primary is hedged and the secondary wins
+   const auto slow_on_primary = "SELECT 1 FROM pg_sleep( CASE WHEN current_setting( 'application_name' ) = 'hedged_primary' THEN 2 ELSE 0 END )";
+   pool->set_hedge_delay( 50ms );
+   TEST_ASSERT( pool->hedge_delay() == std::chrono::microseconds( 50ms ) );
+   TEST_ASSERT( pool->execute( slow_on_primary ).as< int >() == 1 );
+   TEST_ASSERT( pool->hedges() == 1 );
+   TEST_ASSERT( pool->secondary_wins() == 1 );
+   TEST_ASSERT( primary->in_use() == 1 );
+
+   // the loser is cancelled and its connection is returned to its pool
+   for( int i = 0; ( i < 100 ) && ( primary->in_use() != 0 ); ++i ) {
+      TEST_ASSERT( pool->execute( "SELECT 2" ).as< int >() == 2 );
+      std::this_thread::sleep_for( 10ms );
+   }
+   TEST_ASSERT( primary->in_use() == 0 );
+   TEST_ASSERT( pool->hedges() == 1 );
+
+   // statements which are still being cancelled are drained when the hedged pool is destroyed
+   {
+      const auto scoped = tao::pq::hedged_pool::create( primary, secondary );
+      scoped->set_hedge_delay( 50ms );
+      TEST_ASSERT( scoped->execute( slow_on_primary ).as< int >() == 1 );
+      TEST_ASSERT( scoped->secondary_wins() == 1 );
+      TEST_ASSERT( primary->in_use() == 1 );
+   }
+   TEST_ASSERT( primary->in_use() == 0 );
+
+   // SQL errors are reported at once, without failing over
+   TEST_THROWS( pool->execute( "SELECT 1 FROM pg_sleep( .1 ) WHERE FOO" ) );
+   TEST_ASSERT( pool->hedges() == 1 );
+   TEST_ASSERT( pool->failovers() == 0 );
+
+   // fail over to the secondary
+   pool->reset_hedge_delay();
+   const auto broken = tao::pq::hedged_pool::create( tao::pq::connection_pool::create( "dbname=DOES_NOT_EXIST" ), secondary );
+   TEST_ASSERT( broken->execute( "SELECT 3" ).as< int >() == 3 );
+   TEST_ASSERT( broken->hedges() == 0 );
+   TEST_ASSERT( broken->failovers() == 1 );
+   TEST_ASSERT( broken->secondary_wins() == 1 );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../macros.hpp"
+
+#include <chrono>
+#include <string>
+
+#include <tao/pq/internal/histogram.hpp>
+#include <tao/pq/pool_statistics.hpp>
+
+void run()
+{
+   tao::pq::internal::histogram h;
+   TEST_ASSERT( h.snapshot().count == 0 );
+   h.record( std::chrono::microseconds( 10 ) );
+   h.record( std::chrono::microseconds( 16 ) );
+   h.record( std::chrono::microseconds( 17 ) );
+   h.record( std::chrono::seconds( 100 ) );
+
+   const auto s = h.snapshot();
+   TEST_ASSERT( s.bounds.size() == tao::pq::internal::histogram::bounds );
+   TEST_ASSERT( s.counts.size() == s.bounds.size() + 1 );
+   TEST_ASSERT( s.bounds.front() == std::chrono::microseconds( 16 ) );
+   TEST_ASSERT( s.counts[ 0 ] == 2 );
+   TEST_ASSERT( s.counts[ 1 ] == 1 );
+   TEST_ASSERT( s.counts.back() == 1 );
+   TEST_ASSERT( s.count == 4 );
+   TEST_ASSERT( s.sum == std::chrono::microseconds( 100000043 ) );
+
+   tao::pq::pool_statistics ps;
+   ps.idle = 2;
+   ps.in_use = 1;
+   ps.total = 3;
+   ps.created = 4;
+   ps.destroyed = 1;
+   ps.invalidated = 1;
+   ps.result_memory = 4096;
+   ps.checkout_latency = s;
+   ps.hold_time = s;
+
+   const auto plain = tao::pq::to_prometheus( ps );
+   TEST_ASSERT( plain.find( "# TYPE taopq_pool_connections gauge\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "taopq_pool_connections{state=\"idle\"} 2\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "taopq_pool_connections_created_total 4\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "# TYPE taopq_pool_result_memory_bytes gauge\ntaopq_pool_result_memory_bytes 4096\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "# TYPE taopq_pool_checkout_seconds histogram\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "taopq_pool_checkout_seconds_bucket{le=\"1.6e-05\"} 2\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "taopq_pool_checkout_seconds_bucket{le=\"3.2e-05\"} 3\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "taopq_pool_checkout_seconds_bucket{le=\"+Inf\"} 4\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "taopq_pool_checkout_seconds_count 4\n" ) != std::string::npos );
+   TEST_ASSERT( plain.find( "taopq_pool_hold_seconds_sum 100.000043\n" ) != std::string::npos );
+
+   const auto labeled = tao::pq::to_prometheus( ps, "db", "pool=\"main\"" );
+   TEST_ASSERT( labeled.find( "db_connections{pool=\"main\",state=\"in_use\"} 1\n" ) != std::string::npos );
+   TEST_ASSERT( labeled.find( "db_connections_invalidated_total{pool=\"main\"} 1\n" ) != std::string::npos );
+   TEST_ASSERT( labeled.find( "db_hold_seconds_bucket{pool=\"main\",le=\"+Inf\"} 4\n" ) != std::string::npos );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
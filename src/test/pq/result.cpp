@@ -5,6 +5,9 @@
 #include "../getenv.hpp"
 #include "../macros.hpp"
 
+#include <string>
+#include <tuple>
+
 #include <tao/pq/connection.hpp>
 #include <tao/pq/result_traits_optional.hpp>
 #include <tao/pq/result_traits_pair.hpp>
@@ -157,6 +160,43 @@ void run()  // NOLINT(readability-function-size)
       }
    }
    TEST_ASSERT( count == 2 );
+
+   // memory accounting
+   TEST_ASSERT( connection->result_memory() == 0 );
+   {
+      const auto r = connection->execute( "SELECT generate_series( 1, 1000 )" );
+      TEST_ASSERT( r.memory_size() > 1000 );
+      TEST_ASSERT( connection->result_memory() == r.memory_size() );
+      const auto copy = r;
+      TEST_ASSERT( connection->result_memory() == r.memory_size() );
+   }
+   TEST_ASSERT( connection->result_memory() == 0 );
+
+   // result limit, the rows are collected in single-row mode
+   TEST_THROWS( connection->set_result_limit( 0 ) );
+   connection->set_result_limit( 100000 );
+   {
+      const auto r = connection->execute( "SELECT a, CASE WHEN a % 2 = 0 THEN NULL ELSE a::TEXT END FROM generate_series( 1, 1000 ) AS a" );
+      TEST_ASSERT( r.size() == 1000 );
+      TEST_ASSERT( r[ 999 ][ 0 ].as< int >() == 1000 );
+      TEST_ASSERT( r[ 998 ][ 1 ].as< std::string >() == "999" );
+      TEST_ASSERT( r[ 999 ][ 1 ].is_null() );
+      TEST_ASSERT( connection->result_memory() == r.memory_size() );
+   }
+   TEST_ASSERT( connection->execute( "SELECT 42" ).as< int >() == 42 );
+   TEST_ASSERT( connection->execute( "SELECT 42 WHERE false" ).empty() );
+   TEST_THROWS( connection->execute( "SELECT error" ) );
+   try {
+      std::ignore = connection->execute( "SELECT generate_series( 1, 100000000 )" );
+      TEST_FAILED;
+   }
+   catch( const tao::pq::result_limit_exceeded& ) {
+   }
+   TEST_ASSERT( connection->is_idle() );
+   TEST_ASSERT( connection->execute( "SELECT 42" ).as< int >() == 42 );
+   connection->reset_result_limit();
+   TEST_ASSERT( connection->execute( "SELECT generate_series( 1, 100000 )" ).size() == 100000 );
+   TEST_ASSERT( connection->result_memory() == 0 );
 }
 
 auto main() -> int  // NOLINT(bugprone-exception-escape)
@@ -0,0 +1,85 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <chrono>
+#include <thread>
+#include <tuple>
+
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/result_cache.hpp>
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   using namespace std::chrono_literals;
+   const auto pool = tao::pq::connection_pool::create( connection_string );
+   const auto cache = tao::pq::result_cache::create( pool, 1s, 1024 * 1024 );
+
+   TEST_ASSERT( cache->size() == 0 );
+   TEST_ASSERT( cache->memory_usage() == 0 );
+   TEST_ASSERT( cache->hit_rate() == 0.0 );
+
+   // results are cached per statement and parameters
+   const auto first = cache->execute( { "tao_result_cache_test" }, "SELECT random(), $1::INTEGER", 1 );
+   const auto second = cache->execute( { "tao_result_cache_test" }, "SELECT random(), $1::INTEGER", 1 );
+   const auto other = cache->execute( {}, "SELECT random(), $1::INTEGER", 2 );
+   TEST_ASSERT( first[ 0 ][ 0 ].as< double >() == second[ 0 ][ 0 ].as< double >() );
+   TEST_ASSERT( other[ 0 ][ 1 ].as< int >() == 2 );
+   TEST_ASSERT( cache->hits() == 1 );
+   TEST_ASSERT( cache->misses() == 2 );
+   TEST_ASSERT( cache->size() == 2 );
+   TEST_ASSERT( cache->memory_usage() > 0 );
+
+   // a notification evicts the entries of its channel
+   pool->connection()->notify( "tao_result_cache_test" );
+   std::this_thread::sleep_for( 100ms );
+   cache->handle_notifications();
+   TEST_ASSERT( cache->size() == 1 );
+   const auto third = cache->execute( { "tao_result_cache_test" }, "SELECT random(), $1::INTEGER", 1 );
+   TEST_ASSERT( third[ 0 ][ 1 ].as< int >() == 1 );
+   TEST_ASSERT( cache->misses() == 3 );
+
+   // explicit invalidation
+   cache->invalidate( "tao_result_cache_test" );
+   TEST_ASSERT( cache->size() == 1 );
+
+   // entries expire
+   std::this_thread::sleep_for( 1100ms );
+   std::ignore = cache->execute( {}, "SELECT random(), $1::INTEGER", 2 );
+   TEST_ASSERT( cache->misses() == 4 );
+
+   // the memory bound evicts the least recently used entries
+   const auto small = tao::pq::result_cache::create( pool, 1s, 1024 );
+   std::ignore = small->execute( {}, "SELECT 1" );
+   std::ignore = small->execute( {}, "SELECT 2" );
+   TEST_ASSERT( small->memory_usage() <= 1024 );
+   TEST_ASSERT( small->size() <= 1 );
+
+   cache->clear();
+   TEST_ASSERT( cache->size() == 0 );
+   TEST_ASSERT( cache->memory_usage() == 0 );
+   TEST_THROWS( cache->execute( {}, "FOO BAR BAZ" ) );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
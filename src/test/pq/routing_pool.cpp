@@ -0,0 +1,79 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/routing_pool.hpp>
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   using namespace std::chrono_literals;
+   const auto primary = tao::pq::connection_pool::create( connection_string );
+   const auto replica = tao::pq::connection_pool::create( connection_string );
+   const auto pool = tao::pq::routing_pool::create( primary, { replica } );
+
+   TEST_ASSERT( pool->primary() == primary );
+   TEST_ASSERT( pool->replicas() == 1 );
+   TEST_ASSERT( pool->replica( 0 ) == replica );
+   TEST_THROWS( pool->replica( 1 ) );
+   TEST_ASSERT( pool->replay_timeout() == 1s );
+
+   TEST_ASSERT( pool->execute( "SELECT 1" ).as< int >() == 1 );
+   TEST_ASSERT( pool->replica_latency( 0 ) == 0us );
+
+   // read-only transactions are routed to the replica
+   {
+      const auto tr = pool->transaction( tao::pq::access_mode::read_only );
+      TEST_ASSERT( tr->execute( "SELECT current_setting( 'transaction_read_only' )" ).as< std::string >() == "on" );
+   }
+   TEST_ASSERT( pool->replica_latency( 0 ) > 0us );
+   {
+      const auto tr = pool->transaction( tao::pq::isolation_level::serializable );
+      TEST_ASSERT( tr->execute( "SELECT current_setting( 'transaction_read_only' )" ).as< std::string >() == "off" );
+   }
+
+   // read your writes
+   const auto lsn = pool->primary_lsn();
+   TEST_ASSERT( !lsn.empty() );
+   TEST_ASSERT( pool->transaction( lsn )->execute( "SELECT 2" ).as< int >() == 2 );
+   TEST_ASSERT( pool->connection( lsn )->execute( "SELECT 3" ).as< int >() == 3 );
+   TEST_THROWS( pool->connection( "INVALID" ) );
+
+   // broken replicas are skipped
+   const auto broken = tao::pq::routing_pool::create( primary, { tao::pq::connection_pool::create( "dbname=DOES_NOT_EXIST" ) } );
+   TEST_ASSERT( broken->connection( tao::pq::access_mode::read_only )->execute( "SELECT 4" ).as< int >() == 4 );
+   TEST_ASSERT( broken->transaction( tao::pq::access_mode::read_only )->execute( "SELECT 5" ).as< int >() == 5 );
+
+   // without replicas, everything is routed to the primary
+   const auto single = tao::pq::routing_pool::create( connection_string, {} );
+   single->set_replay_timeout( 10ms );
+   TEST_ASSERT( single->replay_timeout() == 10ms );
+   TEST_ASSERT( single->transaction( single->primary_lsn() )->execute( "SELECT 6" ).as< int >() == 6 );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/scatter_gather.hpp>
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   using namespace std::chrono_literals;
+   TEST_THROWS( tao::pq::scatter_gather::create( {} ) );
+
+   const auto a = tao::pq::connection_pool::create( connection_string );
+   const auto b = tao::pq::connection_pool::create( connection_string );
+   const auto sg = tao::pq::scatter_gather::create( { a, b } );
+   TEST_ASSERT( sg->pools().size() == 2 );
+
+   // the statements run concurrently
+   const auto start = std::chrono::steady_clock::now();
+   const auto results = sg->execute( "SELECT $1::INTEGER FROM pg_sleep( .2 )", 42 );
+   TEST_ASSERT( std::chrono::steady_clock::now() - start < 400ms );
+   TEST_ASSERT( results.size() == 2 );
+   TEST_ASSERT( tao::pq::scatter_gather::failures( results ) == 0 );
+   TEST_EXECUTE( tao::pq::scatter_gather::check( results ) );
+   for( const auto& r : results ) {
+      TEST_ASSERT( r );
+      TEST_ASSERT( r.result->as< int >() == 42 );
+      TEST_ASSERT( r.latency >= 200ms );
+   }
+
+   // partial failures
+   const auto broken = tao::pq::scatter_gather::create( { a, tao::pq::connection_pool::create( "dbname=DOES_NOT_EXIST" ) } );
+   const auto partial = broken->execute( "SELECT 1" );
+   TEST_ASSERT( tao::pq::scatter_gather::failures( partial ) == 1 );
+   TEST_ASSERT( partial[ 0 ] );
+   TEST_ASSERT( !partial[ 1 ] );
+   TEST_ASSERT( partial[ 1 ].error );
+   TEST_THROWS( tao::pq::scatter_gather::check( partial ) );
+
+   // per target timeout
+   sg->set_timeout( 100ms );
+   TEST_ASSERT( sg->timeout() == 100ms );
+   const auto timed_out = sg->execute( "SELECT 1 FROM pg_sleep( .5 )" );
+   TEST_ASSERT( tao::pq::scatter_gather::failures( timed_out ) == 2 );
+   sg->reset_timeout();
+   TEST_ASSERT( !sg->timeout() );
+
+   // streaming
+   std::vector< std::size_t > order;
+   sg->stream( [ & ]( const std::size_t index, tao::pq::scatter_gather::target_result&& r ) {
+      TEST_ASSERT( r );
+      order.push_back( index );
+   },
+               "SELECT 1 FROM pg_sleep( $1 )",
+               0.1 );
+   TEST_ASSERT( order.size() == 2 );
+
+   // partitions and merging
+   const auto single = tao::pq::scatter_gather::create( { a } );
+   const auto parts = single->execute_partitioned( "SELECT i FROM generate_series( $1::INTEGER, 10, 3 ) i ORDER BY i", std::vector< int >{ 1, 2, 3 } );
+   TEST_ASSERT( parts.size() == 3 );
+   std::vector< int > merged;
+   tao::pq::scatter_gather::merge< int >( parts, "i", [ & ]( const tao::pq::row& row ) { merged.push_back( row.get< int >( 0 ) ); } );
+   TEST_ASSERT( merged == std::vector< int >{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/sharded_pool.hpp>
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   TEST_THROWS( tao::pq::sharded_pool::create( 0 ) );
+
+   const auto pool = tao::pq::sharded_pool::create();
+   TEST_ASSERT( pool->virtual_nodes() == 128 );
+   TEST_THROWS( pool->shard_name( "tenant" ) );
+
+   const auto a = tao::pq::connection_pool::create( connection_string );
+   const auto b = tao::pq::connection_pool::create( connection_string );
+   pool->add_shard( "a", a );
+   pool->add_shard( "b", b );
+   pool->add_shard( "c", connection_string );
+   TEST_THROWS( pool->add_shard( "a", b ) );
+   TEST_ASSERT( pool->shards() == std::vector< std::string >{ "a", "b", "c" } );
+
+   // keys are spread over all shards
+   std::map< std::string, std::string > before;
+   std::map< std::string, int > counts;
+   for( int i = 0; i < 1000; ++i ) {
+      const auto key = "tenant" + std::to_string( i );
+      before[ key ] = pool->shard_name( key );
+      ++counts[ before[ key ] ];
+   }
+   TEST_ASSERT( counts.size() == 3 );
+   for( const auto& [ name, count ] : counts ) {
+      TEST_ASSERT( count > 200 );
+   }
+
+   // removing a shard only moves the keys of that shard
+   pool->remove_shard( "c" );
+   TEST_THROWS( pool->remove_shard( "c" ) );
+   for( const auto& [ key, name ] : before ) {
+      if( name != "c" ) {
+         TEST_ASSERT( pool->shard_name( key ) == name );
+      }
+   }
+
+   // borrowed connections survive a rebalancing
+   const auto tr = pool->transaction( "tenant1" );
+   TEST_ASSERT( tr->execute( "SELECT 1" ).as< int >() == 1 );
+   pool->rebalance( { { "a", a } } );
+   TEST_ASSERT( pool->shard_name( "tenant1" ) == "a" );
+   TEST_ASSERT( tr->execute( "SELECT 2" ).as< int >() == 2 );
+   tr->commit();
+
+   TEST_ASSERT( pool->execute( "tenant2", "SELECT 3" ).as< int >() == 3 );
+
+   const auto stats = pool->statistics();
+   TEST_ASSERT( stats.size() == 1 );
+   TEST_ASSERT( stats[ 0 ].name == "a" );
+   TEST_ASSERT( stats[ 0 ].requests >= 1 );
+   TEST_ASSERT( stats[ 0 ].idle_connections >= 1 );
+   TEST_ASSERT( stats[ 0 ].virtual_nodes == 128 );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
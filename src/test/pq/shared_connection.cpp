@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tao/pq/exception.hpp>
+#include <tao/pq/parameter_traits_optional.hpp>
+#include <tao/pq/result_traits_optional.hpp>
+#include <tao/pq/shared_connection.hpp>
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   const auto connection = tao::pq::shared_connection::create( connection_string );
+
+   TEST_ASSERT( connection->execute( "SELECT 42" ).get().as< int >() == 42 );
+   TEST_ASSERT( connection->execute( "SELECT $1 || $2", "foo", std::string( "bar" ) ).get().as< std::string >() == "foobar" );
+   TEST_ASSERT( !connection->execute( "SELECT $1::INTEGER", std::optional< int >() ).get().as< std::optional< int > >() );
+
+   // an error only affects the statement which caused it
+   auto failing = connection->execute( "FOO BAR BAZ" );
+   auto succeeding = connection->execute( "SELECT 1" );
+   TEST_THROWS( failing.get() );
+   TEST_ASSERT( succeeding.get().as< int >() == 1 );
+
+   // many threads share the connection
+   std::atomic< int > sum( 0 );
+   std::vector< std::thread > threads;
+   for( int i = 0; i < 8; ++i ) {
+      threads.emplace_back( [ &, i ] {
+         std::vector< std::future< tao::pq::result > > futures;
+         for( int j = 0; j < 100; ++j ) {
+            futures.push_back( connection->execute( "SELECT $1::INTEGER", i * 100 + j ) );
+         }
+         for( auto& f : futures ) {
+            sum += f.get().as< int >();
+         }
+      } );
+   }
+   for( auto& t : threads ) {
+      t.join();
+   }
+   TEST_ASSERT( sum == 799 * 800 / 2 );
+
+   // queued statements are completed by the destructor
+   {
+      const auto scoped = tao::pq::shared_connection::create( connection_string );
+      auto pending = scoped->execute( "SELECT 1 FROM pg_sleep( .1 )" );
+      scoped->execute( "SELECT 2" ).wait();
+      TEST_ASSERT( pending.get().as< int >() == 1 );
+   }
+
+   // a timeout breaks the connection, the next statement is sent over a new one
+   TEST_ASSERT( !connection->timeout() );
+   TEST_THROWS( connection->set_timeout( std::chrono::milliseconds( 0 ) ) );
+   connection->set_timeout( std::chrono::milliseconds( 100 ) );
+   TEST_ASSERT( connection->timeout() == std::chrono::milliseconds( 100 ) );
+   TEST_THROWS( connection->execute( "SELECT pg_sleep( 1 )" ).get() );
+   TEST_ASSERT( connection->execute( "SELECT 3" ).get().as< int >() == 3 );
+   connection->reset_timeout();
+   TEST_ASSERT( !connection->timeout() );
+
+   TEST_THROWS( tao::pq::shared_connection::create( "dbname=DOES_NOT_EXIST" ) );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/slow_query_log.hpp>
+
+void run()
+{
+   using namespace std::chrono_literals;
+
+   TEST_THROWS( tao::pq::slow_query_log::create( -1ms ) );
+   TEST_THROWS( tao::pq::slow_query_log::create( 40ms, 0 ) );
+
+   const auto log = tao::pq::slow_query_log::create( 40ms, 2 );
+   TEST_ASSERT( log->threshold() == 40ms );
+   TEST_ASSERT( log->capacity() == 2 );
+   TEST_THROWS( log->set_explain( nullptr ) );
+
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   const auto pool = tao::pq::connection_pool::create( connection_string );
+   const auto explain_pool = tao::pq::connection_pool::create( connection_string );
+   TEST_THROWS( log->set_explain( explain_pool, 0.0 ) );
+   TEST_THROWS( log->set_explain( explain_pool, 1.5 ) );
+   TEST_THROWS( log->set_explain( explain_pool, 1.0, 0ms ) );
+   TEST_ASSERT( log->explain_pending() == 0 );
+   pool->set_hooks( log );
+
+   // fast statements are not captured
+   TEST_ASSERT( pool->execute( "SELECT 1" ).as< int >() == 1 );
+   TEST_ASSERT( log->captured() == 0 );
+
+   TEST_ASSERT( pool->execute( "SELECT $1 FROM pg_sleep( .05 )", std::string_view( "foo" ) ).as< std::string >() == "foo" );
+   TEST_ASSERT( log->captured() == 1 );
+   {
+      const auto entries = log->entries();
+      TEST_ASSERT( entries.size() == 1 );
+      TEST_ASSERT( entries[ 0 ].event.statement == "SELECT $1 FROM pg_sleep( .05 )" );
+      TEST_ASSERT( entries[ 0 ].event.types.size() == 1 );
+      TEST_ASSERT( entries[ 0 ].event.types[ 0 ] == tao::pq::oid::text );
+      TEST_ASSERT( entries[ 0 ].duration >= 40ms );
+      TEST_ASSERT( !entries[ 0 ].plan );
+   }
+
+   // EXPLAIN for every other statement
+   log->set_explain( explain_pool, 0.5 );
+   TEST_ASSERT( pool->execute( "SELECT $1 + 1 FROM pg_sleep( .05 )", 41 ).as< int >() == 42 );
+   TEST_ASSERT( pool->execute( "SELECT $1 + 1 FROM pg_sleep( .05 )", 42 ).as< int >() == 43 );
+   TEST_ASSERT( log->captured() == 3 );
+   {
+      // the plan is obtained later, not within the hook
+      const auto entries = log->entries();
+      TEST_ASSERT( entries.size() == 2 );
+      TEST_ASSERT( !entries[ 1 ].plan );
+   }
+   TEST_ASSERT( log->explain_pending() == 1 );
+   TEST_ASSERT( log->explain_pending() == 0 );
+   {
+      // the ring buffer keeps the most recent entries
+      const auto entries = log->entries();
+      TEST_ASSERT( entries.size() == 2 );
+      TEST_ASSERT( !entries[ 0 ].plan );
+      TEST_ASSERT( entries[ 1 ].plan );
+      TEST_ASSERT( entries[ 1 ].plan->find( "\"Plan\"" ) != std::string::npos );
+      TEST_ASSERT( entries[ 0 ].captured <= entries[ 1 ].captured );
+   }
+
+   // the temporary prepared statement was removed
+   const auto connection = explain_pool->connection();
+   TEST_ASSERT( connection->execute( "SELECT count(*) FROM pg_prepared_statements" ).as< int >() == 0 );
+
+   // utility statements have no plan
+   log->set_explain( explain_pool );
+   pool->execute( "DO $$ BEGIN PERFORM pg_sleep( .05 ); END $$" );
+   TEST_ASSERT( log->explain_pending() == 1 );
+   TEST_ASSERT( !log->entries().back().plan );
+
+   // statements cleared before they were explained are skipped
+   TEST_ASSERT( pool->execute( "SELECT 1 FROM pg_sleep( .05 )" ).as< int >() == 1 );
+   log->clear();
+   TEST_ASSERT( log->entries().empty() );
+   TEST_ASSERT( log->captured() == 5 );
+   TEST_ASSERT( log->explain_pending() == 0 );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
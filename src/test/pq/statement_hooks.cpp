@@ -0,0 +1,135 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/statement_hooks.hpp>
+#include <tao/pq/statement_statistics.hpp>
+
+class recorder
+   : public tao::pq::statement_hooks
+{
+public:
+   std::size_t started = 0;
+   std::size_t sent = 0;
+   std::size_t first_bytes = 0;
+   std::vector< tao::pq::statement_event > results;
+
+   void on_start( const tao::pq::statement_event& /*unused*/ ) override
+   {
+      ++started;
+   }
+
+   void on_sent( const tao::pq::statement_event& /*unused*/ ) override
+   {
+      ++sent;
+   }
+
+   void on_first_byte( const tao::pq::statement_event& /*unused*/ ) override
+   {
+      ++first_bytes;
+   }
+
+   void on_result( const tao::pq::statement_event& e ) override
+   {
+      results.push_back( e );
+   }
+};
+
+void run()
+{
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   const auto connection = tao::pq::connection::create( connection_string );
+   const auto hooks = std::make_shared< recorder >();
+   TEST_ASSERT( !connection->hooks() );
+   connection->set_hooks( hooks );
+   TEST_ASSERT( connection->hooks() == hooks );
+
+   TEST_ASSERT( connection->execute( "SELECT generate_series( 1, $1 )", 3 ).size() == 3 );
+   TEST_ASSERT( hooks->started == 1 );
+   TEST_ASSERT( hooks->sent == 1 );
+   TEST_ASSERT( hooks->first_bytes == 1 );
+   TEST_ASSERT( hooks->results.size() == 1 );
+   {
+      const auto& e = hooks->results.back();
+      TEST_ASSERT( e.statement == "SELECT generate_series( 1, $1 )" );
+      TEST_ASSERT( !e.prepared );
+      TEST_ASSERT( e.parameters == 1 );
+      TEST_ASSERT( e.bytes_sent == e.statement.size() + 1 );
+      TEST_ASSERT( e.bytes_received == 3 );
+      TEST_ASSERT( e.rows == 3 );
+      TEST_ASSERT( e.start <= e.sent );
+      TEST_ASSERT( e.sent <= e.first_byte );
+      TEST_ASSERT( e.first_byte <= e.done );
+   }
+
+   // prepared statements are reported by name
+   connection->prepare( "hooked", "SELECT $1::TEXT" );
+   TEST_ASSERT( connection->execute( "hooked", "abc" ).as< std::string >() == "abc" );
+   TEST_ASSERT( hooks->results.back().statement == "hooked" );
+   TEST_ASSERT( hooks->results.back().prepared );
+   TEST_ASSERT( hooks->results.back().bytes_sent == 3 );
+
+   // errors are reported as well
+   const auto before = hooks->results.size();
+   TEST_THROWS( connection->execute( "SELECT error" ) );
+   TEST_ASSERT( hooks->results.size() == before + 1 );
+   TEST_ASSERT( hooks->results.back().rows == 0 );
+
+   connection->reset_hooks();
+   TEST_ASSERT( connection->execute( "SELECT 1" ).as< int >() == 1 );
+   TEST_ASSERT( hooks->results.size() == before + 1 );
+
+   // connection pools install their hooks on all borrowed connections
+   const auto pool = tao::pq::connection_pool::create( connection_string );
+   const auto pool_hooks = std::make_shared< recorder >();
+   pool->set_hooks( pool_hooks );
+   TEST_ASSERT( pool->execute( "SELECT 1" ).as< int >() == 1 );
+   TEST_ASSERT( pool_hooks->results.size() == 1 );
+   pool->reset_hooks();
+   TEST_ASSERT( pool->execute( "SELECT 1" ).as< int >() == 1 );
+   TEST_ASSERT( pool_hooks->results.size() == 1 );
+
+   // several hooks are combined with a list
+   const auto first = std::make_shared< recorder >();
+   const auto second = std::make_shared< recorder >();
+   const auto stats = tao::pq::statement_statistics::create();
+   const auto list = tao::pq::statement_hooks_list::create( { first, nullptr, second, stats } );
+   TEST_ASSERT( list->hooks().size() == 3 );
+   connection->set_hooks( list );
+   TEST_ASSERT( connection->execute( "SELECT 1" ).as< int >() == 1 );
+   TEST_ASSERT( first->started == 1 );
+   TEST_ASSERT( first->first_bytes == 1 );
+   TEST_ASSERT( first->results.size() == 1 );
+   TEST_ASSERT( second->sent == 1 );
+   TEST_ASSERT( second->results.size() == 1 );
+   TEST_ASSERT( stats->records().size() == 1 );
+   connection->reset_hooks();
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
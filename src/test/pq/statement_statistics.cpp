@@ -0,0 +1,110 @@
+// Copyright (c) 2022 Daniel Frey and Dr. Colin Hirsch
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "../getenv.hpp"
+#include "../macros.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include <tao/pq/connection.hpp>
+#include <tao/pq/connection_pool.hpp>
+#include <tao/pq/statement_statistics.hpp>
+#include <tao/pq/table_writer.hpp>
+
+void run()
+{
+   // histogram
+   tao::pq::statement_histogram h;
+   TEST_ASSERT( h.percentile( 50 ) == std::chrono::microseconds( 0 ) );
+   for( int i = 1; i <= 1000; ++i ) {
+      h.record( std::chrono::microseconds( i ) );
+   }
+   TEST_ASSERT( h.count() == 1000 );
+   TEST_ASSERT( h.min() == std::chrono::microseconds( 1 ) );
+   TEST_ASSERT( h.max() == std::chrono::microseconds( 1000 ) );
+   TEST_ASSERT( h.mean() == std::chrono::microseconds( 500 ) );
+   TEST_ASSERT( h.percentile( 0 ) == std::chrono::microseconds( 1 ) );
+   TEST_ASSERT( h.percentile( 100 ) == std::chrono::microseconds( 1000 ) );
+   TEST_ASSERT( h.percentile( 50 ) >= std::chrono::microseconds( 500 ) );
+   TEST_ASSERT( h.percentile( 50 ) <= std::chrono::microseconds( 516 ) );
+   TEST_ASSERT( h.percentile( 99 ) >= std::chrono::microseconds( 990 ) );
+   TEST_THROWS( h.percentile( 101 ) );
+
+   // normalization
+   using tao::pq::statement_statistics;
+   TEST_ASSERT( statement_statistics::normalize( "SELECT  1" ) == "SELECT ?" );
+   TEST_ASSERT( statement_statistics::normalize( " SELECT *\n FROM t1 WHERE a = $1 AND b = 'x''y' " ) == "SELECT * FROM t1 WHERE a = $1 AND b = ?" );
+   TEST_ASSERT( statement_statistics::normalize( "SELECT \"col 2\", 1.5e3 FROM t" ) == "SELECT \"col 2\", ? FROM t" );
+
+   // overwrite the default with an environment variable if needed
+   const auto connection_string = tao::pq::internal::getenv( "TAOPQ_TEST_DATABASE", "dbname=template1" );
+
+   const auto stats = statement_statistics::create();
+   const auto pool = tao::pq::connection_pool::create( connection_string );
+   pool->set_hooks( stats );
+
+   for( int i = 0; i < 3; ++i ) {
+      TEST_ASSERT( pool->execute( "SELECT generate_series( 1, " + std::to_string( i + 1 ) + " )" ).size() == std::size_t( i + 1 ) );
+   }
+   const auto series = stats->record( "SELECT generate_series( ?, ? )" );
+   TEST_ASSERT( series );
+   TEST_ASSERT( series->calls == 3 );
+   TEST_ASSERT( series->errors == 0 );
+   TEST_ASSERT( series->rows == 6 );
+   TEST_ASSERT( series->bytes_received == 6 );
+   TEST_ASSERT( series->latency.count() == 3 );
+
+   TEST_THROWS( pool->execute( "SELECT error" ) );
+   TEST_ASSERT( stats->record( "SELECT error" )->errors == 1 );
+
+   // COPY
+   const auto connection = pool->connection();
+   connection->execute( "DROP TABLE IF EXISTS tao_statement_statistics" );
+   connection->execute( "CREATE TABLE tao_statement_statistics ( a INTEGER, b TEXT )" );
+   const auto tr = connection->transaction();
+   tao::pq::table_writer tw( tr, "COPY tao_statement_statistics ( a, b ) FROM STDIN" );
+   tw.insert( 1, "one" );
+   tw.insert( 2, "two" );
+   TEST_ASSERT( tw.commit() == 2 );
+   const auto copy = stats->record( "COPY tao_statement_statistics ( a, b ) FROM STDIN" );
+   TEST_ASSERT( copy );
+   TEST_ASSERT( copy->rows == 2 );
+   TEST_ASSERT( copy->bytes_sent > copy->key.size() );
+   tr->commit();
+
+   // records are ordered by total latency
+   TEST_ASSERT( pool->execute( "SELECT pg_sleep( .05 )" ).size() == 1 );
+   TEST_ASSERT( stats->records().front().key == "SELECT pg_sleep( ? )" );
+
+   const auto text = stats->dump();
+   TEST_ASSERT( text.find( "calls\terrors\t" ) == 0 );
+   TEST_ASSERT( text.find( "\tSELECT generate_series( ?, ? )\n" ) != std::string::npos );
+
+   const std::string filename = "taopq_statement_statistics.txt";
+   stats->dump( filename );
+   TEST_ASSERT( std::remove( filename.c_str() ) == 0 );
+   TEST_THROWS( stats->dump( "/nonexistent/taopq_statement_statistics.txt" ) );
+
+   stats->reset();
+   TEST_ASSERT( stats->records().empty() );
+}
+
+auto main() -> int  // NOLINT(bugprone-exception-escape)
+{
+   try {
+      run();
+   }
+   // LCOV_EXCL_START
+   catch( const std::exception& e ) {
+      std::cerr << "exception: " << e.what() << std::endl;
+      throw;
+   }
+   catch( ... ) {
+      std::cerr << "unknown exception" << std::endl;
+      throw;
+   }
+   // LCOV_EXCL_STOP
+}
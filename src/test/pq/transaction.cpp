@@ -117,6 +117,58 @@ void run()
 
    TEST_EXECUTE( check_nested( connection, connection->direct() ) );
    TEST_EXECUTE( check_nested( connection, connection->transaction() ) );
+   TEST_EXECUTE( check_nested( connection, connection->write_behind_transaction() ) );
+
+   // deferred statements are pipelined until the next result is requested
+   {
+      const auto tr = connection->write_behind_transaction();
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 10 )" ) );
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( $1 )", 11 ) );
+      TEST_ASSERT( connection->has_deferred() );
+      TEST_ASSERT( tr->execute( "SELECT * FROM tao_transaction_test" ).size() == 4 );
+      TEST_ASSERT( !connection->has_deferred() );
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 12 )" ) );
+      TEST_EXECUTE( tr->commit() );
+      TEST_ASSERT( !connection->has_deferred() );
+   }
+   TEST_ASSERT( connection->execute( "SELECT * FROM tao_transaction_test" ).size() == 5 );
+
+   // errors of deferred statements are reported by the next read or the commit
+   {
+      const auto tr = connection->write_behind_transaction();
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 13 )" ) );
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 10 )" ) );
+      TEST_THROWS( tr->execute( "SELECT 42" ) );
+   }
+   {
+      const auto tr = connection->write_behind_transaction();
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 13 )" ) );
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 10 )" ) );
+      TEST_THROWS( tr->commit() );
+   }
+   TEST_ASSERT( connection->is_idle() );
+   TEST_ASSERT( connection->execute( "SELECT * FROM tao_transaction_test" ).size() == 5 );
+
+   // rollback discards pending deferred statements and their errors
+   {
+      const auto tr = connection->write_behind_transaction();
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 10 )" ) );
+      TEST_EXECUTE( tr->rollback() );
+   }
+   {
+      const auto tr = connection->write_behind_transaction();
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 13 )" ) );
+   }
+   TEST_ASSERT( connection->is_idle() );
+   TEST_ASSERT( connection->execute( "SELECT * FROM tao_transaction_test" ).size() == 5 );
+
+   // deferred statements in a direct transaction are synchronized by commit()
+   {
+      const auto tr = connection->direct();
+      TEST_EXECUTE( tr->defer( "INSERT INTO tao_transaction_test VALUES ( 13 )" ) );
+      TEST_EXECUTE( tr->commit() );
+   }
+   TEST_ASSERT( connection->execute( "SELECT * FROM tao_transaction_test" ).size() == 6 );
 }
 
 auto main() -> int